@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <atomic>
+
+#include "util/ThreadPool.h"
+
+namespace nse
+{
+	namespace util
+	{
+		// Lock-free union-find data structure (disjoint sets) which many threads can modify concurrently.
+		// Roots are linked below the root with the smaller index with a single compare-and-swap, so the representative
+		// of every set is its smallest entry. The resulting partition and representatives do not depend on the
+		// number of threads or the order of the merges.
+		class ConcurrentUnionFind
+		{
+			// Node is root iff parent index == index
+
+		public:
+			typedef unsigned int index_t;
+
+			ConcurrentUnionFind();
+
+			// Creates count entries, each in its own set. The entries are initialized in parallel on pool (nullptr uses the shared pool).
+			explicit ConcurrentUnionFind(std::size_t count, ThreadPool* pool = nullptr);
+
+			// Replaces the structure by count entries, each in its own set. Must not run concurrently with other calls.
+			void Reset(std::size_t count, ThreadPool* pool = nullptr);
+
+			// Returns the number of entries
+			std::size_t size() const;
+
+			// Finds the set representative for a given entry with path halving. Concurrent halving steps only ever
+			// move an entry closer to its root, so this is safe during concurrent merges. Returns the smallest entry of the set
+			// once all merges have finished.
+			index_t GetRepresentative(index_t index);
+
+			// Merges the sets of the two specified entries. Returns the root of the merged set at the time of the merge.
+			index_t Merge(index_t i1, index_t i2);
+
+			// Returns if the two entries are in the same set. The result is exact for merges that have finished before the call.
+			bool SameSet(index_t i1, index_t i2);
+
+		private:
+			std::vector<std::atomic<index_t>> parentIndices;
+		};
+	}
+}
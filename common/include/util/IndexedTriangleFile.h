@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace nse
+{
+	namespace util
+	{
+		// Binary file of an indexed triangle mesh, which can be read and written in chunks.
+		// Layout: the header, NumVertices() float32 x, y, z triples, NumTriangles() uint32 vertex index triples.
+		struct IndexedTriangleFileHeader
+		{
+			char magic[4];
+			std::uint32_t version;
+			std::uint64_t numVertices;
+			std::uint64_t numTriangles;
+
+			static const char Magic[4];
+			static const std::uint32_t CurrentVersion = 1;
+		};
+
+		// Reads the vertices and triangles of an indexed triangle file sequentially.
+		class IndexedTriangleReader
+		{
+		public:
+			IndexedTriangleReader();
+			~IndexedTriangleReader();
+
+			IndexedTriangleReader(const IndexedTriangleReader&) = delete;
+			IndexedTriangleReader& operator=(const IndexedTriangleReader&) = delete;
+
+			// Opens the file and reads its header. Returns false if the file cannot be opened or is not an indexed triangle file.
+			bool Open(const char* filename);
+
+			void Close();
+
+			std::uint64_t NumVertices() const;
+			std::uint64_t NumTriangles() const;
+
+			// Moves to the first vertex or the first triangle. Returns false if the file cannot be positioned.
+			bool SeekVertices();
+			bool SeekTriangles();
+
+			// Reads up to maxCount vertices (3 floats each) or triangles (3 indices each) from the current position.
+			// Returns the number of elements read, which is smaller than maxCount only at the end of the section or on errors.
+			std::size_t ReadVertices(float* xyz, std::size_t maxCount);
+			std::size_t ReadTriangles(std::uint32_t* indices, std::size_t maxCount);
+
+		private:
+			bool Seek(std::uint64_t offset);
+
+			FILE* file;
+			IndexedTriangleFileHeader header;
+			// number of elements left in the current section
+			std::uint64_t remaining;
+		};
+
+		// Writes an indexed triangle file. All vertices have to be written before the first triangle.
+		class IndexedTriangleWriter
+		{
+		public:
+			IndexedTriangleWriter();
+			// Closes the file if it is still open
+			~IndexedTriangleWriter();
+
+			IndexedTriangleWriter(const IndexedTriangleWriter&) = delete;
+			IndexedTriangleWriter& operator=(const IndexedTriangleWriter&) = delete;
+
+			// Creates the file. Returns false if it cannot be created.
+			bool Open(const char* filename);
+
+			// Appends vertices or triangles. Returns false if the data cannot be written or vertices follow triangles.
+			bool WriteVertices(const float* xyz, std::size_t count);
+			bool WriteTriangles(const std::uint32_t* indices, std::size_t count);
+
+			// Writes the final header and closes the file. Returns false if any write failed.
+			bool Close();
+
+		private:
+			FILE* file;
+			IndexedTriangleFileHeader header;
+			bool failed;
+		};
+	}
+}
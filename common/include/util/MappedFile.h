@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+namespace nse
+{
+	namespace util
+	{
+		// Read-only memory mapping of an entire file. The operating system pages the file in on demand.
+		class MappedFile
+		{
+		public:
+			MappedFile();
+			~MappedFile();
+
+			MappedFile(MappedFile&& other);
+			MappedFile& operator=(MappedFile&& other);
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			// Maps the specified file. An existing mapping is closed first.
+			// Returns false if the file cannot be opened or mapped.
+			bool Open(const char* filename);
+
+			// Unmaps the file
+			void Close();
+
+			bool IsOpen() const;
+
+			// Returns the first byte of the mapping. Empty files have no data.
+			const void* Data() const;
+
+			// Returns the number of mapped bytes
+			std::size_t Size() const;
+
+		private:
+			bool isOpen;
+			const void* data;
+			std::size_t size;
+#ifdef _WIN32
+			void* fileHandle;
+			void* mappingHandle;
+#endif
+		};
+	}
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
 #include <Eigen/Core>
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
@@ -54,6 +57,16 @@ static Eigen::Vector4f ToEigenVector4(const OpenMesh::Vec2f& v, float z = 0, flo
 	return Eigen::Vector4f(v[0], v[1], z, w);
 }
 
+//Returns the indices of the triangle list that MeshRenderer::Update renders, polygons are split into triangle fans.
+std::vector<uint32_t> TriangleListIndices(const HEMesh& mesh);
+
+//Reads an indexed triangle file (see nse::util::IndexedTriangleReader) into mesh, triangles which OpenMesh rejects are skipped.
+//Returns false if the file cannot be read.
+bool ReadIndexedTriangleMesh(const char* filename, HEMesh& mesh);
+
+//Reads mesh files with OpenMesh or, for the extension .itri, with ReadIndexedTriangleMesh. Returns false if the file cannot be read.
+bool ReadMeshFile(const std::string& filename, HEMesh& mesh);
+
 //GPU representation of a mesh with rendering capabilities.
 class MeshRenderer
 {
@@ -65,6 +78,10 @@ public:
 
 	void UpdateWithPerFaceColor(OpenMesh::FPropHandleT<Eigen::Vector4f> colorProperty);
 
+	//Reorders the triangles for the post-transform vertex cache and the vertices in the order of their first use
+	//in subsequent calls of Update() (see nse::util::OptimizeVertexCache)
+	void SetOptimizeVertexCache(bool optimize);
+
 	void Render(const Eigen::Matrix4f& view, const Eigen::Matrix4f& projection, bool flatShading = false, bool withTexCoords = false, const Eigen::Vector4f& color = Eigen::Vector4f(0.8f, 0.7f, 0.6f, 1.0f)) const;
 	void RenderTextureMap(const Eigen::Matrix4f& projection, const Eigen::Vector4f& color) const;
 
@@ -81,4 +98,5 @@ private:
 	nse::gui::GLVertexArray vao, vaoTexCoords;
 
 	bool hasColor = false;
+	bool optimizeVertexCache = false;
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+namespace nse
+{
+	namespace util
+	{
+		// A fixed set of worker threads which execute parallel loops.
+		// The calling thread takes part in every loop, so a pool with n threads starts n - 1 workers.
+		// Only one loop runs at a time; loops must not be started from inside a loop body.
+		class ThreadPool
+		{
+		public:
+			// Creates a pool with the specified number of threads. 0 uses the number of hardware threads.
+			explicit ThreadPool(unsigned int numThreads = 0);
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			// Returns the shared pool with one thread per hardware thread
+			static ThreadPool* Instance();
+
+			unsigned int NumThreads() const;
+
+			// Splits [0, count) into NumThreads() contiguous ranges of (almost) equal size and calls
+			// body(begin, end, part) for range number part on thread number part. The partition only depends on
+			// count and the number of threads, which makes per-part results reproducible.
+			void ParallelFor(std::size_t count, const std::function<void(std::size_t begin, std::size_t end, unsigned int part)>& body);
+
+			// Splits [0, count) into ranges of chunkSize elements which idle threads take one after the other
+			// and calls body(begin, end) for each of them. Use this if the cost per element varies.
+			void ParallelForChunks(std::size_t count, std::size_t chunkSize, const std::function<void(std::size_t begin, std::size_t end)>& body);
+
+		private:
+			void WorkerLoop(unsigned int thread);
+			// Executes job(thread) on all threads and waits for them
+			void Run(const std::function<void(unsigned int thread)>& job);
+
+			std::vector<std::thread> workers;
+			std::mutex mutex;
+			std::condition_variable jobAvailable, jobFinished;
+			const std::function<void(unsigned int)>* job;
+			std::size_t generation;
+			unsigned int busyWorkers;
+			bool shutdown;
+		};
+	}
+}
@@ -1,7 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <utility>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "util/MappedFile.h"
+#include "util/ThreadPool.h"
 
 namespace nse
 {
@@ -15,15 +21,42 @@ namespace nse
 		public:
 			typedef unsigned int index_t;
 
-			// Saves the entire structure to a file for later usage
+			// Header of the files written by SaveToFile. It is followed by the parent indices of all entries (uint32)
+			// and their ranks (uint8). The checksum is computed over the parent indices and ranks.
+			struct FileHeader
+			{
+				char magic[4];
+				std::uint32_t version;
+				std::uint64_t entries;
+				std::uint64_t checksum;
+
+				static const char Magic[4];
+				static const std::uint32_t CurrentVersion = 2;
+			};
+
+			// Saves the entire structure to a file for later usage. Every entry is stored with its set representative
+			// as parent, such that the file can be used for constant-time lookups (see MapFromFile).
+			// Throws std::runtime_error if the file cannot be written.
 			void SaveToFile(const char* filename) const;
 
 			// Returns the number of entries
 			std::size_t size() const;
 
 			// Loads the entire structure from a file. Existing data in the structure is overridden.
+			// Also reads files of the unversioned format with 32-bit ranks.
+			// Throws std::runtime_error if the file cannot be read or is corrupted.
 			void LoadFromFile(const char* filename);
 
+			// Maps a file written by SaveToFile read-only instead of loading it. Existing data in the structure is overridden.
+			// Until the next call of Clear() or LoadFromFile(), GetRepresentative() is a single lookup in the file
+			// and all modifications throw std::logic_error. Copies of the structure share the mapping.
+			// Verifying the checksum reads the entire file.
+			// Throws std::runtime_error if the file cannot be mapped or is corrupted.
+			void MapFromFile(const char* filename, bool verifyChecksum = true);
+
+			// Returns if the structure is mapped read-only from a file
+			bool IsMapped() const;
+
 			// Adds an item to the structure
 			void AddItem();
 
@@ -42,11 +75,34 @@ namespace nse
 			//newRoot must already be the representative of itself.
 			void MergeWithPredefinedRoot(index_t newRoot, index_t i);
 
+			// Merges the sets of the entries of every pair, in order. Same result as calling Merge() for every pair,
+			// but the parent chains of upcoming pairs are prefetched to hide the memory latency of random accesses.
+			void MergeBatch(const std::pair<index_t, index_t>* pairs, std::size_t count);
+			void MergeBatch(const std::vector<std::pair<index_t, index_t>>& pairs);
+
+			// Numbers the sets densely from 0 to k - 1 in the order of their representatives and returns k.
+			// labels receives the number of the set of every entry, sizes the number of entries of every set.
+			// Runs in parallel on pool (nullptr uses the shared pool) and flattens the structure, such that later calls
+			// of GetRepresentative() return immediately.
+			std::size_t CompactLabels(std::vector<index_t>& labels, std::vector<index_t>& sizes, ThreadPool* pool = nullptr);
+
 		private:
 			void ConcreteMerge(index_t newRoot, index_t child);
 
+			// Throws std::logic_error if the structure is mapped read-only
+			void CheckWritable() const;
+
+			// Returns the header and the flattened parent indices of the mapped file
+			const FileHeader& MappedHeader() const;
+			const index_t* MappedParents() const;
+
 			std::vector<index_t> parentIndices;
-			std::vector<unsigned int> ranks;
+			// Union by rank keeps the ranks below log2(size()), so 8 bits suffice. Only MergeWithPredefinedRoot can
+			// exceed this bound, the ranks saturate in this case.
+			std::vector<std::uint8_t> ranks;
+
+			// File written by SaveToFile if the structure is mapped read-only, shared by all copies
+			std::shared_ptr<const MappedFile> mappedFile;
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nse
+{
+	namespace util
+	{
+		// Replacement policy of a simulated post-transform vertex cache
+		enum class VertexCacheModel
+		{
+			FIFO,
+			LRU,
+		};
+
+		// Result of a post-transform vertex cache simulation
+		struct VertexCacheStats
+		{
+			std::size_t numTriangles = 0;
+			// Number of distinct vertices referenced by the triangles
+			std::size_t numVertices = 0;
+			// Number of cache misses, i.e. vertex shader invocations
+			std::size_t numTransforms = 0;
+
+			// Average cache miss ratio, transformed vertices per triangle. 0.5 is the optimum for large regular meshes.
+			double ACMR() const;
+			// Average transform to vertex ratio, 1 means that every vertex is transformed only once.
+			double ATVR() const;
+		};
+
+		// Counts the vertex transformations of an indexed triangle list for a cache with cacheSize entries.
+		VertexCacheStats SimulateVertexCache(const std::vector<uint32_t>& indices, std::size_t numVertices, VertexCacheModel model, unsigned int cacheSize);
+
+		// Reorders the triangles of an indexed triangle list for the post-transform vertex cache with Tom Forsyth's
+		// linear-speed algorithm. Triangles are emitted greedily by a score which favors vertices that are in a
+		// simulated LRU cache of cacheSize entries and vertices with few remaining triangles. If no cached vertex has
+		// a remaining triangle, the next triangle in input order is taken.
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, std::size_t numVertices, unsigned int cacheSize = 32);
+
+		// Renumbers the vertices in the order of their first use in indices, such that vertex fetches become mostly
+		// sequential. Unreferenced vertices are moved to the end. Returns the new index of every old vertex, use
+		// RemapVertices() to reorder the vertex attributes accordingly.
+		std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, std::size_t numVertices);
+
+		// Reorders vertex attributes with the result of OptimizeVertexFetch()
+		template <typename T>
+		void RemapVertices(std::vector<T>& attributes, const std::vector<uint32_t>& remap)
+		{
+			std::vector<T> result(attributes.size());
+			for (std::size_t i = 0; i < attributes.size(); ++i)
+				result[remap[i]] = attributes[i];
+			attributes.swap(result);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#include "util/ConcurrentUnionFind.h"
+
+#include <utility>
+
+using namespace nse::util;
+
+ConcurrentUnionFind::ConcurrentUnionFind()
+{ }
+
+ConcurrentUnionFind::ConcurrentUnionFind(std::size_t count, ThreadPool* pool)
+{
+	Reset(count, pool);
+}
+
+void ConcurrentUnionFind::Reset(std::size_t count, ThreadPool* pool)
+{
+	if (pool == nullptr)
+		pool = ThreadPool::Instance();
+
+	// std::atomic is not movable, the vector has to be replaced instead of resized
+	parentIndices = std::vector<std::atomic<index_t>>(count);
+	pool->ParallelFor(count, [this](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			parentIndices[i].store((index_t)i, std::memory_order_relaxed);
+	});
+}
+
+std::size_t ConcurrentUnionFind::size() const { return parentIndices.size(); }
+
+ConcurrentUnionFind::index_t ConcurrentUnionFind::GetRepresentative(index_t index)
+{
+	while (true)
+	{
+		index_t parent = parentIndices[index].load(std::memory_order_relaxed);
+		if (parent == index)
+			return index;
+		index_t grandparent = parentIndices[parent].load(std::memory_order_relaxed);
+		// Path halving, a failed exchange means that another thread has already moved the entry up
+		if (grandparent != parent)
+			parentIndices[index].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+		index = grandparent;
+	}
+}
+
+ConcurrentUnionFind::index_t ConcurrentUnionFind::Merge(index_t i1, index_t i2)
+{
+	while (true)
+	{
+		i1 = GetRepresentative(i1);
+		i2 = GetRepresentative(i2);
+		if (i1 == i2)
+			return i1;
+		if (i1 > i2)
+			std::swap(i1, i2);
+
+		// i2 is linked below i1 only if it is still a root, otherwise retry from its new parent
+		index_t expected = i2;
+		if (parentIndices[i2].compare_exchange_strong(expected, i1, std::memory_order_relaxed))
+			return i1;
+		i2 = expected;
+	}
+}
+
+bool ConcurrentUnionFind::SameSet(index_t i1, index_t i2)
+{
+	while (true)
+	{
+		i1 = GetRepresentative(i1);
+		i2 = GetRepresentative(i2);
+		if (i1 == i2)
+			return true;
+		// Different roots only prove different sets if i1 has not been linked in the meantime
+		if (parentIndices[i1].load(std::memory_order_relaxed) == i1)
+			return false;
+	}
+}
@@ -0,0 +1,157 @@
+#include "util/IndexedTriangleFile.h"
+
+#include <cstring>
+
+using namespace nse::util;
+
+const char IndexedTriangleFileHeader::Magic[4] = { 'I', 'T', 'R', 'I' };
+
+// Positions the file at an absolute 64 bit offset
+static bool SeekFile(FILE* file, std::uint64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+IndexedTriangleReader::IndexedTriangleReader()
+	: file(nullptr), remaining(0)
+{
+	memset(&header, 0, sizeof(header));
+}
+
+IndexedTriangleReader::~IndexedTriangleReader()
+{
+	Close();
+}
+
+bool IndexedTriangleReader::Open(const char* filename)
+{
+	Close();
+	file = fopen(filename, "rb");
+	if (file == nullptr)
+		return false;
+	if (fread(&header, sizeof(header), 1, file) != 1
+		|| memcmp(header.magic, IndexedTriangleFileHeader::Magic, 4) != 0
+		|| header.version != IndexedTriangleFileHeader::CurrentVersion)
+	{
+		Close();
+		return false;
+	}
+	remaining = header.numVertices;
+	return true;
+}
+
+void IndexedTriangleReader::Close()
+{
+	if (file != nullptr)
+		fclose(file);
+	file = nullptr;
+	remaining = 0;
+}
+
+std::uint64_t IndexedTriangleReader::NumVertices() const { return header.numVertices; }
+
+std::uint64_t IndexedTriangleReader::NumTriangles() const { return header.numTriangles; }
+
+bool IndexedTriangleReader::Seek(std::uint64_t offset)
+{
+	return file != nullptr && SeekFile(file, offset);
+}
+
+bool IndexedTriangleReader::SeekVertices()
+{
+	if (!Seek(sizeof(header)))
+		return false;
+	remaining = header.numVertices;
+	return true;
+}
+
+bool IndexedTriangleReader::SeekTriangles()
+{
+	if (!Seek(sizeof(header) + header.numVertices * 3 * sizeof(float)))
+		return false;
+	remaining = header.numTriangles;
+	return true;
+}
+
+std::size_t IndexedTriangleReader::ReadVertices(float* xyz, std::size_t maxCount)
+{
+	if (file == nullptr)
+		return 0;
+	std::size_t count = (std::size_t)(maxCount < remaining ? maxCount : remaining);
+	count = fread(xyz, 3 * sizeof(float), count, file);
+	remaining -= count;
+	return count;
+}
+
+std::size_t IndexedTriangleReader::ReadTriangles(std::uint32_t* indices, std::size_t maxCount)
+{
+	if (file == nullptr)
+		return 0;
+	std::size_t count = (std::size_t)(maxCount < remaining ? maxCount : remaining);
+	count = fread(indices, 3 * sizeof(std::uint32_t), count, file);
+	remaining -= count;
+	return count;
+}
+
+IndexedTriangleWriter::IndexedTriangleWriter()
+	: file(nullptr), failed(false)
+{
+	memset(&header, 0, sizeof(header));
+}
+
+IndexedTriangleWriter::~IndexedTriangleWriter()
+{
+	Close();
+}
+
+bool IndexedTriangleWriter::Open(const char* filename)
+{
+	Close();
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, IndexedTriangleFileHeader::Magic, 4);
+	header.version = IndexedTriangleFileHeader::CurrentVersion;
+	failed = false;
+	file = fopen(filename, "wb");
+	if (file == nullptr)
+		return false;
+	// the header is written again with the final counts when the file is closed
+	if (fwrite(&header, sizeof(header), 1, file) != 1)
+		failed = true;
+	return !failed;
+}
+
+bool IndexedTriangleWriter::WriteVertices(const float* xyz, std::size_t count)
+{
+	if (file == nullptr || header.numTriangles != 0)
+		return false;
+	if (fwrite(xyz, 3 * sizeof(float), count, file) != count)
+		failed = true;
+	header.numVertices += count;
+	return !failed;
+}
+
+bool IndexedTriangleWriter::WriteTriangles(const std::uint32_t* indices, std::size_t count)
+{
+	if (file == nullptr)
+		return false;
+	if (fwrite(indices, 3 * sizeof(std::uint32_t), count, file) != count)
+		failed = true;
+	header.numTriangles += count;
+	return !failed;
+}
+
+bool IndexedTriangleWriter::Close()
+{
+	if (file == nullptr)
+		return false;
+	if (!SeekFile(file, 0) || fwrite(&header, sizeof(header), 1, file) != 1)
+		failed = true;
+	if (fclose(file) != 0)
+		failed = true;
+	file = nullptr;
+	return !failed;
+}
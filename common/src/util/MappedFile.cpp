@@ -0,0 +1,139 @@
+#include "util/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace nse::util;
+
+MappedFile::MappedFile()
+	: isOpen(false), data(nullptr), size(0)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+{ }
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+	: MappedFile()
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+	std::swap(isOpen, other.isOpen);
+	std::swap(data, other.data);
+	std::swap(size, other.size);
+#ifdef _WIN32
+	std::swap(fileHandle, other.fileHandle);
+	std::swap(mappingHandle, other.mappingHandle);
+#endif
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+	fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+	size = (std::size_t)fileSize.QuadPart;
+	isOpen = true;
+	//empty files cannot be mapped
+	if (size == 0)
+		return true;
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle != nullptr)
+		data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat fileStats;
+	if (fstat(fd, &fileStats) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	size = (std::size_t)fileStats.st_size;
+	if (size > 0)
+	{
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			::close(fd);
+			size = 0;
+			return false;
+		}
+		data = mapping;
+	}
+	//the mapping stays valid after the descriptor is closed
+	::close(fd);
+	isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		munmap(const_cast<void*>(data), size);
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const { return isOpen; }
+
+const void* MappedFile::Data() const { return data; }
+
+std::size_t MappedFile::Size() const { return size; }
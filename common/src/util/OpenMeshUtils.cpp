@@ -1,7 +1,11 @@
 #include "util/OpenMeshUtils.h"
 
 #include <vector>
+#include <iostream>
+#include <OpenMesh/Core/IO/MeshIO.hh>
 #include <gui/ShaderPool.h>
+#include <util/VertexCache.h>
+#include <util/IndexedTriangleFile.h>
 
 MeshRenderer::MeshRenderer(const HEMesh& mesh)
 	: mesh(mesh), indexCount(0),
@@ -38,6 +42,63 @@ void TriangulateMeshFace(HEMesh::FaceHandle f, const HEMesh& mesh, EmitTriangleF
 	}
 }
 
+std::vector<uint32_t> TriangleListIndices(const HEMesh& mesh)
+{
+	std::vector<uint32_t> indices;
+	indices.reserve(mesh.n_faces() * 3);
+	for (auto f : mesh.faces())
+	{
+		TriangulateMeshFace(f, mesh, [&](const HEMesh::HalfedgeHandle h[3])
+		{
+			indices.push_back(mesh.to_vertex_handle(h[0]).idx());
+			indices.push_back(mesh.to_vertex_handle(h[1]).idx());
+			indices.push_back(mesh.to_vertex_handle(h[2]).idx());
+		});
+	}
+	return indices;
+}
+
+bool ReadIndexedTriangleMesh(const char* filename, HEMesh& mesh)
+{
+	nse::util::IndexedTriangleReader reader;
+	if (!reader.Open(filename))
+		return false;
+
+	mesh.clear();
+	std::vector<float> xyz(3 * reader.NumVertices());
+	std::vector<uint32_t> indices(3 * reader.NumTriangles());
+	if (reader.ReadVertices(xyz.data(), reader.NumVertices()) != reader.NumVertices()
+		|| !reader.SeekTriangles() || reader.ReadTriangles(indices.data(), reader.NumTriangles()) != reader.NumTriangles())
+		return false;
+
+	mesh.reserve(reader.NumVertices(), 3 * reader.NumTriangles() / 2, reader.NumTriangles());
+	for (size_t i = 0; i < xyz.size(); i += 3)
+		mesh.add_vertex(OpenMesh::Vec3f(xyz[i], xyz[i + 1], xyz[i + 2]));
+	size_t skipped = 0;
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		if (indices[i] >= mesh.n_vertices() || indices[i + 1] >= mesh.n_vertices() || indices[i + 2] >= mesh.n_vertices()
+			|| !mesh.add_face(HEMesh::VertexHandle(indices[i]), HEMesh::VertexHandle(indices[i + 1]), HEMesh::VertexHandle(indices[i + 2])).is_valid())
+			++skipped;
+	}
+	if (skipped > 0)
+		std::cerr << "Skipped " << skipped << " invalid or non-manifold triangles of " << filename << std::endl;
+	return true;
+}
+
+bool ReadMeshFile(const std::string& filename, HEMesh& mesh)
+{
+	const std::string extension = ".itri";
+	if (filename.size() >= extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
+		return ReadIndexedTriangleMesh(filename.c_str(), mesh);
+	return OpenMesh::IO::read_mesh(mesh, filename);
+}
+
+void MeshRenderer::SetOptimizeVertexCache(bool optimize)
+{
+	optimizeVertexCache = optimize;
+}
+
 void MeshRenderer::Update()
 {
 	if (mesh.n_vertices() == 0)
@@ -62,22 +123,23 @@ void MeshRenderer::Update()
 		if (mesh.has_vertex_texcoords2D())
 			uvs.push_back(ToEigenVector(mesh.texcoord2D(v)));
 	}
+
+	std::vector<uint32_t> indices = TriangleListIndices(mesh);
+	if (optimizeVertexCache)
+	{
+		nse::util::OptimizeVertexCache(indices, mesh.n_vertices());
+		auto remap = nse::util::OptimizeVertexFetch(indices, mesh.n_vertices());
+		nse::util::RemapVertices(positions, remap);
+		nse::util::RemapVertices(normals, remap);
+		if (mesh.has_vertex_texcoords2D())
+			nse::util::RemapVertices(uvs, remap);
+	}
+
 	positionBuffer.uploadData(positions).bindToAttribute("position");
 	normalBuffer.uploadData(normals).bindToAttribute("normal");
 	if (mesh.has_vertex_texcoords2D())
 		texCoordBuffer.uploadData(uvs).bindToAttribute("texCoords");
 
-	std::vector<uint32_t> indices;
-	indices.reserve(mesh.n_faces() * 3);
-	for (auto f : mesh.faces())
-	{
-		TriangulateMeshFace(f, mesh, [&](const HEMesh::HalfedgeHandle h[3])
-		{
-			indices.push_back(mesh.to_vertex_handle(h[0]).idx());
-			indices.push_back(mesh.to_vertex_handle(h[1]).idx());
-			indices.push_back(mesh.to_vertex_handle(h[2]).idx());
-		});
-	}
 	indexBuffer.uploadData(sizeof(uint32_t) * (uint32_t)indices.size(), indices.data());
 	indexCount = (unsigned int)indices.size();
 
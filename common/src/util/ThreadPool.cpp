@@ -0,0 +1,111 @@
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+
+using namespace nse::util;
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+	: job(nullptr), generation(0), busyWorkers(0), shutdown(false)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int i = 1; i < numThreads; ++i)
+		workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		shutdown = true;
+	}
+	jobAvailable.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+ThreadPool* ThreadPool::Instance()
+{
+	static ThreadPool instance;
+	return &instance;
+}
+
+unsigned int ThreadPool::NumThreads() const
+{
+	return (unsigned int)workers.size() + 1;
+}
+
+void ThreadPool::WorkerLoop(unsigned int thread)
+{
+	std::size_t seenGeneration = 0;
+	while (true)
+	{
+		const std::function<void(unsigned int)>* currentJob;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [&]() { return shutdown || generation != seenGeneration; });
+			if (shutdown)
+				return;
+			seenGeneration = generation;
+			currentJob = job;
+		}
+
+		(*currentJob)(thread);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busyWorkers == 0)
+				jobFinished.notify_one();
+		}
+	}
+}
+
+void ThreadPool::Run(const std::function<void(unsigned int thread)>& job)
+{
+	if (workers.empty())
+	{
+		job(0);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		busyWorkers = (unsigned int)workers.size();
+		++generation;
+	}
+	jobAvailable.notify_all();
+
+	job(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobFinished.wait(lock, [&]() { return busyWorkers == 0; });
+	this->job = nullptr;
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t begin, std::size_t end, unsigned int part)>& body)
+{
+	unsigned int parts = NumThreads();
+	Run([&](unsigned int part)
+	{
+		std::size_t begin = count * part / parts;
+		std::size_t end = count * (part + 1) / parts;
+		if (begin < end)
+			body(begin, end, part);
+	});
+}
+
+void ThreadPool::ParallelForChunks(std::size_t count, std::size_t chunkSize, const std::function<void(std::size_t begin, std::size_t end)>& body)
+{
+	chunkSize = std::max<std::size_t>(1, chunkSize);
+	std::atomic<std::size_t> next(0);
+	Run([&](unsigned int)
+	{
+		while (true)
+		{
+			std::size_t begin = next.fetch_add(chunkSize);
+			if (begin >= count)
+				break;
+			body(begin, std::min(count, begin + chunkSize));
+		}
+	});
+}
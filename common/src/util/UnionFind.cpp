@@ -2,49 +2,226 @@
 
 #include <stdio.h>
 #include <cstdint>
+#include <cstring>
 #include <cassert>
+#include <memory>
+#include <limits>
+#include <string>
+#include <algorithm>
 #include <stdexcept>
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 using namespace nse::util;
 
+const char UnionFind::FileHeader::Magic[4] = { 'U', 'N', 'F', 'D' };
+
+namespace
+{
+	typedef std::unique_ptr<FILE, int(*)(FILE*)> FilePtr;
+
+	// Ranks are only a balancing heuristic, they saturate instead of overflowing
+	const unsigned int MaxRank = std::numeric_limits<uint8_t>::max();
+
+	// Incremental FNV-1a over whole values
+	struct Checksum
+	{
+		uint64_t hash = 14695981039346656037ull;
+
+		template <typename T>
+		void Add(const T* values, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				hash ^= (uint64_t)values[i];
+				hash *= 1099511628211ull;
+			}
+		}
+	};
+
+	// Requests the cache line of address without waiting for it
+	inline void Prefetch(const void* address)
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+
+	template <typename T>
+	void ReadArray(FILE* file, T* data, uint64_t count)
+	{
+		// Empty vectors may not have any storage
+		if (count == 0)
+			return;
+		if (fread(data, sizeof(T), (size_t)count, file) != count)
+			throw std::runtime_error("Cannot read enough data from file");
+	}
+
+	template <typename T>
+	void WriteArray(FILE* file, const T* data, size_t count, const char* filename)
+	{
+		if (count == 0)
+			return;
+		if (fwrite(data, sizeof(T), count, file) != count)
+			throw std::runtime_error(std::string("Cannot write to file ") + filename);
+	}
+}
+
 void UnionFind::SaveToFile(const char* filename) const
 {
-	FILE* file = fopen(filename, "wb");
-	uint64_t entries = size();
-	fwrite(&entries, sizeof(uint64_t), 1, file);
-	fwrite(&parentIndices[0], sizeof(index_t), parentIndices.size(), file);
-	fwrite(&ranks[0], sizeof(unsigned int), ranks.size(), file);
-	fclose(file);
+	FilePtr file(fopen(filename, "wb"), &fclose);
+	if (!file)
+		throw std::runtime_error(std::string("Cannot create file ") + filename);
+
+	const index_t* parents = IsMapped() ? MappedParents() : parentIndices.data();
+	const uint8_t* rankData = IsMapped() ? reinterpret_cast<const uint8_t*>(MappedParents() + size()) : ranks.data();
+
+	// The header is written again with the checksum at the end
+	FileHeader header;
+	memcpy(header.magic, FileHeader::Magic, 4);
+	header.version = FileHeader::CurrentVersion;
+	header.entries = size();
+	header.checksum = 0;
+	WriteArray(file.get(), &header, 1, filename);
+
+	// Flatten every entry to its root in blocks, without modifying the structure
+	Checksum checksum;
+	const size_t blockSize = 1 << 16;
+	std::vector<index_t> roots(std::min(blockSize, size()));
+	for (size_t begin = 0; begin < size(); begin += blockSize)
+	{
+		size_t end = std::min(size(), begin + blockSize);
+		for (size_t i = begin; i < end; ++i)
+		{
+			index_t root = parents[i];
+			while (parents[root] != root)
+				root = parents[root];
+			roots[i - begin] = root;
+		}
+		checksum.Add(roots.data(), end - begin);
+		WriteArray(file.get(), roots.data(), end - begin, filename);
+	}
+	checksum.Add(rankData, size());
+	WriteArray(file.get(), rankData, size(), filename);
+
+	header.checksum = checksum.hash;
+	if (fseek(file.get(), 0, SEEK_SET) != 0)
+		throw std::runtime_error(std::string("Cannot write to file ") + filename);
+	WriteArray(file.get(), &header, 1, filename);
+	if (fclose(file.release()) != 0)
+		throw std::runtime_error(std::string("Cannot write to file ") + filename);
 }
 
-std::size_t UnionFind::size() const { return parentIndices.size(); }
+std::size_t UnionFind::size() const { return IsMapped() ? (std::size_t)MappedHeader().entries : parentIndices.size(); }
 
 // Loads the entire structure from a file. Existing data in the structure is overridden.
 void UnionFind::LoadFromFile(const char* filename)
 {
-	uint64_t entries;
+	Clear();
+
+	FilePtr file(fopen(filename, "rb"), &fclose);
+	if (!file)
+		throw std::runtime_error(std::string("Cannot open file ") + filename);
+
+	// Files of the unversioned format start directly with the number of entries
+	uint8_t start[8];
+	ReadArray(file.get(), start, sizeof(start));
+	if (memcmp(start, FileHeader::Magic, 4) != 0)
+	{
+		uint64_t entries;
+		memcpy(&entries, start, sizeof(uint64_t));
+		if (entries > (uint64_t)std::numeric_limits<index_t>::max() + 1)
+			throw std::runtime_error("Invalid number of entries in union-find file");
+		parentIndices.resize(entries);
+		ReadArray(file.get(), parentIndices.data(), entries);
+		std::vector<unsigned int> wideRanks(entries);
+		ReadArray(file.get(), wideRanks.data(), entries);
+		ranks.resize(entries);
+		for (size_t i = 0; i < entries; ++i)
+			ranks[i] = (uint8_t)std::min(wideRanks[i], MaxRank);
+		return;
+	}
+
+	FileHeader header;
+	static_assert(sizeof(FileHeader) > sizeof(start), "The header has to start with the 8 bytes read before");
+	memcpy(&header, start, sizeof(start));
+	ReadArray(file.get(), reinterpret_cast<uint8_t*>(&header) + sizeof(start), sizeof(FileHeader) - sizeof(start));
+	if (header.version != FileHeader::CurrentVersion)
+		throw std::runtime_error("Unsupported union-find file version " + std::to_string(header.version));
+	if (header.entries > (uint64_t)std::numeric_limits<index_t>::max() + 1)
+		throw std::runtime_error("Invalid number of entries in union-find file");
 
-	FILE* file = fopen(filename, "rb");
-	if(fread(&entries, sizeof(uint64_t), 1, file) != 1)
-		throw std::runtime_error("Cannot read enough data from file");
-	parentIndices.resize(entries);
-	ranks.resize(entries);
-	if(fread(&parentIndices[0], sizeof(index_t), entries, file) != entries)
-		throw std::runtime_error("Cannot read enough data from file");
-	if(fread(&ranks[0], sizeof(unsigned int), entries, file) != entries)
-		throw std::runtime_error("Cannot read enough data from file");
-	fclose(file);
+	parentIndices.resize(header.entries);
+	ranks.resize(header.entries);
+	ReadArray(file.get(), parentIndices.data(), header.entries);
+	ReadArray(file.get(), ranks.data(), header.entries);
+
+	Checksum checksum;
+	checksum.Add(parentIndices.data(), parentIndices.size());
+	checksum.Add(ranks.data(), ranks.size());
+	if (checksum.hash != header.checksum)
+	{
+		Clear();
+		throw std::runtime_error(std::string("Checksum mismatch in union-find file ") + filename);
+	}
 }
 
+void UnionFind::MapFromFile(const char* filename, bool verifyChecksum)
+{
+	Clear();
+	auto file = std::make_shared<MappedFile>();
+	if (!file->Open(filename))
+		throw std::runtime_error(std::string("Cannot map file ") + filename);
+	mappedFile = file;
+
+	bool valid = mappedFile->Size() >= sizeof(FileHeader);
+	if (valid)
+	{
+		const FileHeader& header = MappedHeader();
+		valid = memcmp(header.magic, FileHeader::Magic, 4) == 0
+			&& header.version == FileHeader::CurrentVersion
+			&& header.entries == (mappedFile->Size() - sizeof(FileHeader)) / (sizeof(index_t) + sizeof(uint8_t))
+			&& mappedFile->Size() == sizeof(FileHeader) + header.entries * (sizeof(index_t) + sizeof(uint8_t));
+	}
+	if (!valid)
+	{
+		mappedFile.reset();
+		throw std::runtime_error(std::string("Not a union-find file of version ") + std::to_string(FileHeader::CurrentVersion) + ": " + filename);
+	}
+
+	if (verifyChecksum)
+	{
+		Checksum checksum;
+		checksum.Add(MappedParents(), size());
+		checksum.Add(reinterpret_cast<const uint8_t*>(MappedParents() + size()), size());
+		if (checksum.hash != MappedHeader().checksum)
+		{
+			mappedFile.reset();
+			throw std::runtime_error(std::string("Checksum mismatch in union-find file ") + filename);
+		}
+	}
+}
+
+bool UnionFind::IsMapped() const { return mappedFile != nullptr; }
+
 // Adds an item to the structure
 void UnionFind::AddItem()
 {
+	CheckWritable();
 	parentIndices.push_back((index_t)parentIndices.size());
 	ranks.push_back(0);
 }
 
 void UnionFind::AddItems(std::size_t count)
 {
+	CheckWritable();
 	auto oldCount = parentIndices.size();
 	parentIndices.resize(parentIndices.size() + count);
 	for (index_t i = static_cast<index_t>(oldCount); i < parentIndices.size(); ++i)
@@ -56,12 +233,17 @@ void UnionFind::Clear()
 {
 	parentIndices.clear();
 	ranks.clear();
+	mappedFile.reset();
 }
 
 // Finds the set representative for a given entry. Two entries are in the same set
 // iff they have the same set representative.
 UnionFind::index_t UnionFind::GetRepresentative(index_t index)
 {
+	// Mapped files are flattened
+	if (IsMapped())
+		return MappedParents()[index];
+
 	//Find the root
 	index_t current = index;
 	while (parentIndices[current] != current)
@@ -83,6 +265,7 @@ UnionFind::index_t UnionFind::GetRepresentative(index_t index)
 // Merges the sets of the two specified entries.
 UnionFind::index_t UnionFind::Merge(index_t i1, index_t i2)
 {
+	CheckWritable();
 	index_t rep1 = GetRepresentative(i1);
 	index_t rep2 = GetRepresentative(i2);
 	if (rep1 == rep2)
@@ -105,13 +288,15 @@ UnionFind::index_t UnionFind::Merge(index_t i1, index_t i2)
 	else
 	{
 		ConcreteMerge(rep1, rep2);
-		++ranks[rep1];
+		if (rank1 < MaxRank)
+			++ranks[rep1];
 		return rep1;
 	}
 }
 
 void UnionFind::MergeWithPredefinedRoot(index_t newRoot, index_t i)
 {
+	CheckWritable();
 	assert(GetRepresentative(newRoot) == newRoot);
 
 	index_t rep2 = GetRepresentative(i);
@@ -122,12 +307,135 @@ void UnionFind::MergeWithPredefinedRoot(index_t newRoot, index_t i)
 	unsigned int rank1 = ranks[newRoot];
 	unsigned int rank2 = ranks[rep2];
 
-	if (rank1 == rank2)
-		++ranks[newRoot];
-	ConcreteMerge(newRoot, i);
+	//The whole subtree of rep2 is attached, not only the entry i
+	if (rank1 <= rank2)
+		ranks[newRoot] = (uint8_t)std::min(rank2 + 1, MaxRank);
+	ConcreteMerge(newRoot, rep2);
+}
+
+void UnionFind::MergeBatch(const std::pair<index_t, index_t>* pairs, std::size_t count)
+{
+	CheckWritable();
+
+	// The parents of the pairs PrefetchDistance ahead are requested first. Half as far ahead, the parents have arrived
+	// and the grandparents are requested, which covers most chains after path compression.
+	const std::size_t PrefetchDistance = 16;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (i + PrefetchDistance < count)
+		{
+			Prefetch(&parentIndices[pairs[i + PrefetchDistance].first]);
+			Prefetch(&parentIndices[pairs[i + PrefetchDistance].second]);
+		}
+		if (i + PrefetchDistance / 2 < count)
+		{
+			auto& upcoming = pairs[i + PrefetchDistance / 2];
+			Prefetch(&parentIndices[parentIndices[upcoming.first]]);
+			Prefetch(&parentIndices[parentIndices[upcoming.second]]);
+		}
+		Merge(pairs[i].first, pairs[i].second);
+	}
+}
+
+void UnionFind::MergeBatch(const std::vector<std::pair<index_t, index_t>>& pairs)
+{
+	MergeBatch(pairs.data(), pairs.size());
+}
+
+std::size_t UnionFind::CompactLabels(std::vector<index_t>& labels, std::vector<index_t>& sizes, ThreadPool* pool)
+{
+	if (pool == nullptr)
+		pool = ThreadPool::Instance();
+	const std::size_t n = size();
+	const index_t* parents = IsMapped() ? MappedParents() : parentIndices.data();
+	labels.resize(n);
+
+	// Step 1: find the root of every entry without modifying the structure and count the roots per part
+	std::vector<std::size_t> partRoots(pool->NumThreads() + 1, 0);
+	pool->ParallelFor(n, [&](std::size_t begin, std::size_t end, unsigned int part)
+	{
+		std::size_t count = 0;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			index_t root = parents[i];
+			while (parents[root] != root)
+				root = parents[root];
+			labels[i] = root;
+			count += root == i;
+		}
+		partRoots[part + 1] = count;
+	});
+	for (std::size_t part = 1; part < partRoots.size(); ++part)
+		partRoots[part] += partRoots[part - 1];
+	const std::size_t numSets = partRoots.back();
+
+	// Step 2: number the roots in order, each root temporarily holds its own label; flatten the other entries
+	pool->ParallelFor(n, [&](std::size_t begin, std::size_t end, unsigned int part)
+	{
+		index_t next = (index_t)partRoots[part];
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			if (parents[i] == i)
+				labels[i] = next++;
+			else if (!IsMapped())
+				parentIndices[i] = labels[i];
+		}
+	});
+
+	// Step 3: all other entries look up the label of their root; runs of the same set are counted locally
+	// to keep the atomic updates rare
+	std::vector<std::atomic<index_t>> counts(numSets);
+	pool->ParallelFor(numSets, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			counts[i].store(0, std::memory_order_relaxed);
+	});
+	pool->ParallelFor(n, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		index_t runLabel = 0, runLength = 0;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			index_t label = parents[i] == i ? labels[i] : labels[labels[i]];
+			if (parents[i] != i)
+				labels[i] = label;
+			if (label != runLabel && runLength > 0)
+			{
+				counts[runLabel].fetch_add(runLength, std::memory_order_relaxed);
+				runLength = 0;
+			}
+			runLabel = label;
+			++runLength;
+		}
+		if (runLength > 0)
+			counts[runLabel].fetch_add(runLength, std::memory_order_relaxed);
+	});
+
+	sizes.resize(numSets);
+	pool->ParallelFor(numSets, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			sizes[i] = counts[i].load(std::memory_order_relaxed);
+	});
+	return numSets;
 }
 
 void UnionFind::ConcreteMerge(index_t newRoot, index_t child)
 {
 	parentIndices[child] = newRoot;
-}
\ No newline at end of file
+}
+
+void UnionFind::CheckWritable() const
+{
+	if (IsMapped())
+		throw std::logic_error("The union-find structure is mapped read-only");
+}
+
+const UnionFind::FileHeader& UnionFind::MappedHeader() const
+{
+	return *reinterpret_cast<const FileHeader*>(mappedFile->Data());
+}
+
+const UnionFind::index_t* UnionFind::MappedParents() const
+{
+	return reinterpret_cast<const index_t*>(static_cast<const char*>(mappedFile->Data()) + sizeof(FileHeader));
+}
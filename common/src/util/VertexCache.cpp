@@ -0,0 +1,204 @@
+#include "util/VertexCache.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+using namespace nse::util;
+
+double VertexCacheStats::ACMR() const
+{
+	return numTriangles == 0 ? 0.0 : (double)numTransforms / numTriangles;
+}
+
+double VertexCacheStats::ATVR() const
+{
+	return numVertices == 0 ? 0.0 : (double)numTransforms / numVertices;
+}
+
+VertexCacheStats nse::util::SimulateVertexCache(const std::vector<uint32_t>& indices, std::size_t numVertices, VertexCacheModel model, unsigned int cacheSize)
+{
+	VertexCacheStats stats;
+	stats.numTriangles = indices.size() / 3;
+
+	std::vector<bool> referenced(numVertices, false);
+	for (auto i : indices)
+	{
+		if (!referenced[i])
+		{
+			referenced[i] = true;
+			++stats.numVertices;
+		}
+	}
+
+	if (model == VertexCacheModel::FIFO)
+	{
+		// A vertex is cached if less than cacheSize vertices were inserted after it
+		std::vector<std::size_t> insertedAt(numVertices, std::numeric_limits<std::size_t>::max());
+		for (auto i : indices)
+		{
+			if (insertedAt[i] == std::numeric_limits<std::size_t>::max() || stats.numTransforms - insertedAt[i] >= cacheSize)
+				insertedAt[i] = stats.numTransforms++;
+		}
+	}
+	else
+	{
+		// Most recently used entry first
+		std::vector<uint32_t> cache;
+		cache.reserve(cacheSize + 1);
+		for (auto i : indices)
+		{
+			auto it = std::find(cache.begin(), cache.end(), i);
+			if (it == cache.end())
+			{
+				++stats.numTransforms;
+				cache.insert(cache.begin(), i);
+				if (cache.size() > cacheSize)
+					cache.pop_back();
+			}
+			else
+				std::rotate(cache.begin(), it, it + 1);
+		}
+	}
+	return stats;
+}
+
+namespace
+{
+	// Score constants from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	const float CacheDecayPower = 1.5f;
+	const float LastTriangleScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+
+	float VertexScore(int cachePosition, uint32_t remainingTriangles, unsigned int cacheSize)
+	{
+		if (remainingTriangles == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// The vertices of the last triangle get a fixed score, such that the next triangle does not
+			// simply reuse the two most recent vertices of a strip
+			if (cachePosition < 3)
+				score = LastTriangleScore;
+			else
+			{
+				float scale = 1.0f / (cacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scale, CacheDecayPower);
+			}
+		}
+		// Prefer vertices with few remaining triangles to avoid leaving lone triangles behind
+		score += ValenceBoostScale * std::pow((float)remainingTriangles, -ValenceBoostPower);
+		return score;
+	}
+}
+
+void nse::util::OptimizeVertexCache(std::vector<uint32_t>& indices, std::size_t numVertices, unsigned int cacheSize)
+{
+	std::size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0)
+		return;
+	cacheSize = std::max(cacheSize, 4u);
+
+	// Triangles per vertex, the remaining (not yet emitted) ones are kept at the front of each range
+	std::vector<uint32_t> remaining(numVertices, 0);
+	for (std::size_t i = 0; i < 3 * numTriangles; ++i)
+		++remaining[indices[i]];
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+	for (std::size_t v = 0; v < numVertices; ++v)
+		offsets[v + 1] = offsets[v] + remaining[v];
+	std::vector<uint32_t> vertexTriangles(3 * numTriangles);
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (std::size_t i = 0; i < 3 * numTriangles; ++i)
+			vertexTriangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<float> score(numVertices);
+	for (std::size_t v = 0; v < numVertices; ++v)
+		score[v] = VertexScore(-1, remaining[v], cacheSize);
+
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<uint32_t> cache, newCache;
+	cache.reserve(cacheSize + 3);
+	newCache.reserve(cacheSize + 3);
+	std::vector<uint32_t> result;
+	result.reserve(3 * numTriangles);
+
+	std::size_t nextInputTriangle = 0;
+	std::size_t best = numTriangles;
+	while (result.size() < 3 * numTriangles)
+	{
+		// Dead end, continue with the first remaining triangle in input order
+		if (best == numTriangles)
+		{
+			while (emitted[nextInputTriangle])
+				++nextInputTriangle;
+			best = nextInputTriangle;
+		}
+
+		const uint32_t* corners = &indices[3 * best];
+		emitted[best] = true;
+		result.insert(result.end(), corners, corners + 3);
+		for (int c = 0; c < 3; ++c)
+		{
+			uint32_t v = corners[c];
+			uint32_t* begin = &vertexTriangles[offsets[v]];
+			uint32_t* last = begin + remaining[v] - 1;
+			std::iter_swap(std::find(begin, last, (uint32_t)best), last);
+			--remaining[v];
+		}
+
+		// The corners move to the front of the cache, vertices pushed out of it lose their cache score
+		newCache.clear();
+		newCache.insert(newCache.end(), corners, corners + 3);
+		for (auto v : cache)
+			if (v != corners[0] && v != corners[1] && v != corners[2])
+				newCache.push_back(v);
+		for (std::size_t i = cacheSize; i < newCache.size(); ++i)
+			score[newCache[i]] = VertexScore(-1, remaining[newCache[i]], cacheSize);
+		if (newCache.size() > cacheSize)
+			newCache.resize(cacheSize);
+		cache.swap(newCache);
+		for (std::size_t i = 0; i < cache.size(); ++i)
+			score[cache[i]] = VertexScore((int)i, remaining[cache[i]], cacheSize);
+
+		// Only the remaining triangles of cached vertices changed their score
+		best = numTriangles;
+		float bestScore = -1.0f;
+		for (auto v : cache)
+		{
+			for (uint32_t k = offsets[v]; k < offsets[v] + remaining[v]; ++k)
+			{
+				uint32_t t = vertexTriangles[k];
+				float triangleScore = score[indices[3 * t]] + score[indices[3 * t + 1]] + score[indices[3 * t + 2]];
+				if (triangleScore > bestScore)
+				{
+					bestScore = triangleScore;
+					best = t;
+				}
+			}
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+std::vector<uint32_t> nse::util::OptimizeVertexFetch(std::vector<uint32_t>& indices, std::size_t numVertices)
+{
+	const uint32_t Unused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(numVertices, Unused);
+	uint32_t next = 0;
+	for (auto& i : indices)
+	{
+		if (remap[i] == Unused)
+			remap[i] = next++;
+		i = remap[i];
+	}
+	for (auto& r : remap)
+		if (r == Unused)
+			r = next++;
+	return remap;
+}
@@ -0,0 +1,41 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "util/OpenMeshUtils.h"
+
+/*
+Flat copy of the faces and vertex positions of a halfedge mesh for bulk computations.
+The positions are stored as separate x, y and z arrays, the faces as compressed rows of vertex indices.
+Polygons are additionally fan-triangulated into a triangle index buffer.
+Vertex and face indices are the indices of the corresponding handles of the source mesh.
+*/
+struct FlatMesh
+{
+	FlatMesh() { }
+
+	//copies the faces and positions of m
+	explicit FlatMesh(const HEMesh& m);
+
+	size_t NumVertices() const { return x.size(); }
+	size_t NumFaces() const { return faceOffsets.empty() ? 0 : faceOffsets.size() - 1; }
+	size_t NumTriangles() const { return triangles.size() / 3; }
+
+	//vertex positions
+	std::vector<float> x, y, z;
+
+	//the vertices of face f are faceVertices[faceOffsets[f]] .. faceVertices[faceOffsets[f + 1] - 1]
+	std::vector<uint32_t> faceOffsets;
+	std::vector<uint32_t> faceVertices;
+	//per entry of faceVertices, 1 if the face is the owner of the edge from this vertex to the next vertex of the face
+	//every edge with at least one face has exactly one owner, which allows to visit all edges in a pass over the faces
+	std::vector<uint8_t> ownsEdge;
+
+	//three vertex indices per triangle, polygons are split into fans around their first vertex
+	std::vector<uint32_t> triangles;
+};
@@ -0,0 +1,58 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstdint>
+#include <Eigen/Sparse>
+
+#include "util/OpenMeshUtils.h"
+
+/*
+Implicit (backward Euler) uniform Laplacian smoothing.
+A step with time step lambda solves (I - lambda * L) p' = p with the uniform Laplacian L = D^-1 (A - D), where A is
+the vertex adjacency matrix and D holds the vertex valences. Multiplied by D, the system becomes
+((1 + lambda) D - lambda A) p' = D p, which is symmetric positive definite and is solved by a sparse LDLT
+factorization for all three coordinates at once. Unlike the explicit smoothing, the step is stable for any lambda.
+
+The factorization is kept between calls. The symbolic analysis is reused while the connectivity of the mesh does
+not change, the numeric factorization while lambda does not change either.
+*/
+class ImplicitSmoothing
+{
+public:
+	ImplicitSmoothing();
+
+	//performs one backward Euler step with time step lambda and updates the vertex positions of m
+	//returns false if the system could not be solved, m is not changed in that case
+	bool SmoothUniform(HEMesh& m, float lambda);
+
+	//discards the cached factorization
+	void Reset();
+
+	//returns the time of the last symbolic analysis, numeric factorization and solve in milliseconds
+	//the analysis and factorization times are zero if the cached ones were used
+	double LastAnalysisTime() const { return analysisTime; }
+	double LastFactorizationTime() const { return factorizationTime; }
+	double LastSolveTime() const { return solveTime; }
+
+private:
+	//returns a hash of the vertex indices of all halfedges
+	static uint64_t ConnectivityHash(const HEMesh& m);
+
+	//assembles the system matrix for lambda, the sparsity pattern only depends on the connectivity
+	void AssembleMatrix(const HEMesh& m, float lambda);
+
+	Eigen::SparseMatrix<double> matrix;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+	//valences of the vertices, isolated vertices get 1 to keep the system regular
+	Eigen::VectorXd valences;
+
+	size_t numVertices, numHalfedges;
+	uint64_t connectivityHash;
+	float factorizedLambda;
+	bool analyzed, factorized;
+
+	double analysisTime, factorizationTime, solveTime;
+};
@@ -0,0 +1,89 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
+#include "SmoothingDiagnostics.h"
+
+/*
+Compiled snapshot of a mesh for repeated Laplacian smoothing.
+The one-ring of every vertex is stored once in compressed sparse row (CSR) arrays and the positions are stored
+as separate x, y and z arrays, so the smoothing iterations run over flat arrays instead of walking circulators.
+The positions are only written back to the mesh by StorePositions.
+Each iteration computes all new positions from the old ones (Jacobi-style), so the vertices are distributed over the
+threads of a thread pool and the result does not depend on the number of threads.
+The cotangent weights are cached per edge. They are computed once per iteration in a pass over the edges, or only
+every few iterations if the weights are frozen (see SetWeightUpdateInterval).
+*/
+class MeshLaplacian
+{
+public:
+	//compiles the connectivity of m and copies its vertex positions
+	//the iterations run on the given thread pool, nullptr uses the shared pool
+	explicit MeshLaplacian(const HEMesh& m, nse::util::ThreadPool* pool = nullptr);
+
+	//sets the thread pool of the iterations, nullptr uses the shared pool
+	void SetThreadPool(nse::util::ThreadPool* pool);
+
+	//copies the vertex positions of m, which must have the connectivity the snapshot was compiled from
+	void LoadPositions(const HEMesh& m);
+
+	//writes the current positions to the vertices of m
+	void StorePositions(HEMesh& m) const;
+
+	//one uniform Laplacian smoothing iteration, same result as SmoothUniformLaplacian
+	void SmoothUniform(float lambda);
+
+	//one cotangent Laplacian smoothing iteration, same result as SmoothCotanLaplacian if the weights are updated every iteration
+	//numerical problems are counted in Diagnostics()
+	void SmoothCotan(float lambda);
+
+	//sets after how many cotangent iterations the edge weights are recomputed, 1 (default) recomputes them in every
+	//iteration, larger values reuse the weights of an earlier iteration, which is faster but less accurate
+	void SetWeightUpdateInterval(unsigned int iterations);
+
+	//forces the edge weights to be recomputed in the next cotangent iteration
+	void InvalidateWeights() { iterationsSinceWeightUpdate = weightUpdateInterval; }
+
+	//returns the numerical problems counted since the construction or the last ResetDiagnostics
+	const SmoothingDiagnostics& Diagnostics() const { return diagnostics; }
+	void ResetDiagnostics() { diagnostics.Reset(); }
+
+	size_t NumVertices() const { return x.size(); }
+
+	//returns the current position of vertex i
+	OpenMesh::Vec3f Position(size_t i) const { return OpenMesh::Vec3f(x[i], y[i], z[i]); }
+
+private:
+	//computes the cotangent weight of every edge from the current positions
+	void ComputeCotanWeights();
+
+	//the neighbors of vertex i are neighbors[offsets[i]] .. neighbors[offsets[i + 1] - 1] in the order of voh_range
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> neighbors;
+	//per CSR entry the edge to the neighbor
+	std::vector<uint32_t> entryEdges;
+	//boundary vertices keep their position in cotangent smoothing
+	std::vector<uint8_t> isBoundary;
+
+	//per edge its two vertices followed by the vertices opposite to it in its two triangles, NoVertex for boundary edges
+	std::vector<uint32_t> edgeVertices;
+	//per edge cotangent weight, NaN marks an invalid weight which is skipped
+	std::vector<float> edgeWeights;
+	unsigned int weightUpdateInterval;
+	unsigned int iterationsSinceWeightUpdate;
+	static const uint32_t NoVertex = 0xFFFFFFFFu;
+
+	nse::util::ThreadPool* pool;
+	SmoothingDiagnostics diagnostics;
+
+	//current positions and the buffer for the next iteration
+	std::vector<float> x, y, z;
+	std::vector<float> nextX, nextY, nextZ;
+};
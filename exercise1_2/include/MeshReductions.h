@@ -0,0 +1,32 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include "util/ThreadPool.h"
+#include "FlatMesh.h"
+
+/*
+Surface area and volume of very large meshes.
+The triangles of a FlatMesh are split into blocks of fixed size which are distributed over the threads of a thread pool.
+Within a block, four triangles are processed at a time (with AVX2 if the processor supports it) in double precision,
+and the block sums are added pairwise. The blocks do not depend on the number of threads, neither does the result.
+*/
+
+//returns if the processor supports the AVX2 kernels
+bool HasAVX2();
+
+//computes the surface area of m, useSimd = false forces the scalar kernel
+//the thread pool nullptr uses the shared pool
+double ComputeSurfaceArea(const FlatMesh& m, bool useSimd = true, nse::util::ThreadPool* pool = nullptr);
+
+//computes the absolute value of the signed volume enclosed by m, see ComputeSurfaceArea for the parameters
+double ComputeVolume(const FlatMesh& m, bool useSimd = true, nse::util::ThreadPool* pool = nullptr);
+
+//sequential long double versions for measuring the error of the other implementations
+long double ComputeSurfaceAreaReference(const FlatMesh& m);
+long double ComputeVolumeReference(const FlatMesh& m);
+
+//compares the halfedge mesh and the flat mesh implementations and prints throughput and errors to the console
+void BenchmarkAreaAndVolume(const HEMesh& m);
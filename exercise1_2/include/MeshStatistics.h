@@ -0,0 +1,41 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <ostream>
+
+#include <math/BoundingBox.h>
+#include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
+
+//geometric properties of a mesh which are computed together in a single pass
+struct MeshStatistics
+{
+	size_t numFaces = 0;
+	size_t numEdges = 0;
+
+	double surfaceArea = 0.0;
+	//volume enclosed by the faces, negative if the faces are oriented inwards
+	//like ComputeVolume, the volume is measured relative to the origin if the mesh is not closed
+	double signedVolume = 0.0;
+	//center of mass of the enclosed solid with uniform density
+	Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+	//inertia tensor of the enclosed solid with unit density with respect to the centroid
+	Eigen::Matrix3d inertia = Eigen::Matrix3d::Zero();
+
+	//bounding box of all vertices
+	nse::math::BoundingBox<float, 3> bbox;
+
+	//length of the shortest, average and longest edge of the faces
+	float minEdgeLength = 0.0f;
+	float meanEdgeLength = 0.0f;
+	float maxEdgeLength = 0.0f;
+};
+
+std::ostream& operator<<(std::ostream& os, const MeshStatistics& stats);
+
+//computes all statistics of m in one parallel pass over its faces and vertices
+//polygons are split into triangle fans, the thread pool nullptr uses the shared pool
+MeshStatistics ComputeMeshStatistics(const HEMesh& m, nse::util::ThreadPool* pool = nullptr);
@@ -0,0 +1,15 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <random>
+
+#include <Eigen/Geometry>
+
+#include "util/OpenMeshUtils.h"
+
+// Offsets the vertex positions with noise along the vertex normal, scaled relative to the bounding box bbox
+// The same seed always produces the same noise
+void AddNoise (HEMesh &m, const Eigen::AlignedBox3f& bbox, unsigned int seed = std::mt19937::default_seed);
@@ -4,6 +4,8 @@
 
 #pragma once
 #include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
+#include "FlatMesh.h"
 
 //create a mesh containing a single quad
 void CreateQuad(HEMesh& m);
@@ -36,3 +38,16 @@ void CreateOctahedron(HEMesh& m, float radius);
 
 //create a unit arrow
 void CreateUnitArrow(HEMesh& m, float stem_radius = 0.04, float head_radius = 0.1, float stem_height = 0.8, int slices = 30, int stem_stacks = 1);
+
+//Variants of the generators above for very high resolutions. They produce the same flat mesh as FlatMesh(const HEMesh&)
+//of the halfedge generators, but write it directly into the arrays, in parallel on pool (nullptr uses the shared pool).
+void CreateCylinder(FlatMesh& m, float radius, float height, int stacks, int slices, nse::util::ThreadPool* pool = nullptr);
+void CreateSphere(FlatMesh& m, float radius, int slices, int stacks, nse::util::ThreadPool* pool = nullptr);
+void CreateTorus(FlatMesh& m, float r, float R, int nsides, int rings, nse::util::ThreadPool* pool = nullptr);
+
+//converts a flat mesh into a halfedge mesh, all storage is reserved upfront, every face starts at the same vertex
+void ToHEMesh(const FlatMesh& flat, HEMesh& m);
+
+//times the halfedge and the flat generators for sphere, torus and cylinder with the given number of slices and stacks
+//and checks that they produce the same mesh, m contains the cylinder afterwards
+void BenchmarkPrimitiveGeneration(HEMesh& m, int resolution);
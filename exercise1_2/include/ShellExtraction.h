@@ -3,8 +3,24 @@
 // Copyright (C) CGV TU Dresden - All Rights Reserved
 
 #pragma once
+#include <vector>
+#include <math/BoundingBox.h>
 #include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
 
 //Finds the connected components in the mesh. Writes the non-negative shell index into perFaceShellIndex
 //and returns the number of shells.
 unsigned int ExtractShells (HEMesh &m, OpenMesh::FPropHandleT<int> perFaceShellIndex);
+
+//Properties of a shell which the parallel shell extraction computes along with the shell indices
+struct ShellInfo
+{
+	unsigned int numFaces = 0;
+	nse::math::BoundingBox<float, 3> bbox;
+};
+
+//Parallel version of ExtractShells with the same result: faces sharing an edge are merged in a lock-free
+//union-find in a pass over the edges, and the shells are numbered in the order of their first face.
+//If shells is not nullptr, it receives the number of faces and the bounding box of every shell.
+unsigned int ExtractShellsParallel (HEMesh &m, OpenMesh::FPropHandleT<int> perFaceShellIndex,
+                                    std::vector<ShellInfo>* shells = nullptr, nse::util::ThreadPool* pool = nullptr);
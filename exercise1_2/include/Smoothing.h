@@ -6,13 +6,36 @@
 
 #include "Viewer.h"
 #include "util/OpenMeshUtils.h"
+#include "SmoothingDiagnostics.h"
+#include "Noise.h"
 
 
 // Updates the vertex positions by Laplacian smoothing
 void SmoothUniformLaplacian (HEMesh &m, float lambda);
 
 // Updates the vertex positions by Laplacian smoothing with cotangent discretization
-void SmoothCotanLaplacian (HEMesh &m, float lambda);
+// Numerical problems are added to diagnostics; without diagnostics, they are reported to std::cerr once per call
+void SmoothCotanLaplacian (HEMesh &m, float lambda, SmoothingDiagnostics* diagnostics = nullptr);
+
+// Applies several uniform Laplacian smoothing iterations on a compiled snapshot of the mesh (see MeshLaplacian)
+void SmoothUniformLaplacian (HEMesh &m, float lambda, unsigned int iterations);
+
+// Applies several cotangent Laplacian smoothing iterations on a compiled snapshot of the mesh (see MeshLaplacian)
+// The cotangent weights are recomputed every weightUpdateInterval iterations
+void SmoothCotanLaplacian (HEMesh &m, float lambda, unsigned int iterations, unsigned int weightUpdateInterval = 1);
+
+// Returns the cotangent of the angle at p0 in the triangle p0, p1, p2, clamped values are counted in issues
+float cotangent (const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2, SmoothingIssueCounts& issues);
+
+// Compares the running times of the circulator-based and the snapshot-based smoothing and prints them to the console
+void BenchmarkSmoothing (const HEMesh &m, float lambda, unsigned int iterations);
+
+// Measures the snapshot-based smoothing with 1 to 32 threads, checks that the results are identical and prints them to the console
+void BenchmarkSmoothingScaling (const HEMesh &m, float lambda, unsigned int iterations);
+
+// Compares counted diagnostics with per-occurrence logging of the cotangent smoothing on a copy of the mesh
+// with many degenerate triangles and prints the times to the console
+void BenchmarkDegenerateSmoothing (const HEMesh &m, float lambda, unsigned int iterations);
 
 // Offsets the vertex positions with noise along the vertex normal
 void AddNoise (HEMesh &m, OpenMesh::MPropHandleT<Viewer::BBoxType> bbox_prop);
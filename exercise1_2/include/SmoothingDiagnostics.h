@@ -0,0 +1,59 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+//numerical problems which the cotangent smoothing detects and works around
+enum class SmoothingIssue
+{
+	//sine of a triangle angle below 1e-6, clamped
+	SmallSine,
+	//cotangent above 1e6 in magnitude, clamped
+	ExtremeCotangent,
+	//NaN cotangent, the edge is skipped
+	InvalidCotangent,
+	//NaN or infinite edge weight, the edge is skipped
+	InvalidWeight,
+	//sum of the edge weights of a vertex below 1e-6, clamped
+	SmallWeightSum,
+	//NaN Laplacian, reset to zero
+	InvalidLaplacian,
+	//NaN new position, the vertex keeps its position
+	InvalidPosition,
+	NumIssues
+};
+
+//issue counts of a single thread, kept in plain integers inside the inner loops
+struct SmoothingIssueCounts
+{
+	size_t counts[(int)SmoothingIssue::NumIssues] = {};
+
+	void Count(SmoothingIssue issue) { ++counts[(int)issue]; }
+};
+
+//issue counts of a whole smoothing call, threads add their local counts once per loop
+class SmoothingDiagnostics
+{
+public:
+	SmoothingDiagnostics();
+
+	//adds the counts of a thread
+	void Add(const SmoothingIssueCounts& local);
+
+	//sets all counts to zero
+	void Reset();
+
+	size_t Count(SmoothingIssue issue) const;
+	size_t Total() const;
+
+	//writes one summary line per issue that occurred to os, writes nothing if no issue occurred
+	void Report(std::ostream& os, const char* operation) const;
+
+private:
+	std::atomic<size_t> counts[(int)SmoothingIssue::NumIssues];
+};
@@ -0,0 +1,31 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//summary of a shell found by the streaming shell extraction
+struct StreamingShell
+{
+	uint64_t numFaces = 0;
+	uint64_t numVertices = 0;
+	//bounding box of the vertices of the shell
+	float lower[3];
+	float upper[3];
+
+	StreamingShell();
+};
+
+//Finds the shells of a triangle mesh file without building a halfedge mesh. The input is either an indexed triangle
+//file (extension .itri, see nse::util::IndexedTriangleFile) or a Wavefront OBJ file, whose polygons are split into
+//triangle fans. Unlike ExtractShells, faces belong to the same shell if they share a vertex.
+//The input is read twice in chunks of chunkSize elements: the first pass merges the vertices of every face in an
+//nse::util::UnionFind, the second pass writes the int32 shell index of every face to shellIdPath and collects the
+//shell summaries. Only per-vertex data is kept in memory, the faces are never stored.
+//The shells are numbered in the order of their first vertex. Returns false and reports to std::cerr on errors.
+bool ExtractShellsStreaming(const std::string& inputPath, const std::string& shellIdPath, std::vector<StreamingShell>& shells,
+	size_t chunkSize = 1 << 20);
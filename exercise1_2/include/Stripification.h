@@ -5,7 +5,53 @@
 #pragma once
 
 #include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
 
 //Extracts triangle strips from the mesh, writes the Strip Id of each face in 
 //perFaceStripIdProperty, and returns the number of strips.
-unsigned int ExtractTriStrips(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials);
\ No newline at end of file
+unsigned int ExtractTriStrips(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials);
+
+//Same as above with a fixed seed for the random start faces. The trials of each strip are evaluated on the threads
+//of pool (or on the calling thread if pool is nullptr); the result only depends on the seed. Every thread that
+//evaluates trials needs 4 bytes per face. The trials are short, so a pool only pays off for many trials on large
+//meshes; the overload above runs on the calling thread.
+unsigned int ExtractTriStrips(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials,
+	unsigned int seed, nse::util::ThreadPool* pool = nullptr);
+
+//Deterministic linear-time alternative to ExtractTriStrips with the same output. Each strip starts at a free
+//face with the fewest free neighbors and is greedily extended to the neighbor with the fewest free neighbors.
+//Strips may turn in the same direction twice, which requires a swap when they are rendered. The mesh must be
+//a triangle mesh. If stripFaces is given, it receives all faces strip by strip in strip order.
+unsigned int ExtractTriStripsGreedy(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
+	std::vector<OpenMesh::FaceHandle>* stripFaces = nullptr);
+
+//How the strips are joined in a single GL_TRIANGLE_STRIP index buffer
+enum class StripJoin
+{
+	//strips are separated by StripRestartIndex, which requires GL_PRIMITIVE_RESTART_FIXED_INDEX
+	//or glPrimitiveRestartIndex(StripRestartIndex)
+	PrimitiveRestart,
+	//strips are connected by degenerate triangles
+	DegenerateTriangles,
+};
+
+const uint32_t StripRestartIndex = 0xFFFFFFFFu;
+
+//Builds a single GL_TRIANGLE_STRIP index buffer of vertex indices from the faces in strip order as returned by
+//ExtractTriStripsGreedy. Turns in the same direction are handled by repeating a vertex (a swap), strips start at
+//even positions such that all triangles keep the orientation of their faces. The mesh must be a triangle mesh.
+std::vector<uint32_t> BuildTriangleStripIndices(const HEMesh& m, const std::vector<OpenMesh::FaceHandle>& stripFaces,
+	OpenMesh::FPropHandleT<int> perFaceStripIdProperty, StripJoin join);
+
+//Reconstructs the triangles of a strip index buffer as OpenGL does and checks that they are exactly the faces
+//of the triangle mesh m with the same orientation. Problems are reported to os.
+bool VerifyTriangleStripIndices(const HEMesh& m, const std::vector<uint32_t>& indices, StripJoin join, std::ostream& os);
+
+//Runs the randomized and the greedy stripification and prints run time and strip lengths of both to the console.
+//For the greedy strips, the index count of both strip buffers is compared to the GL_TRIANGLES list of MeshRenderer
+//and both buffers are verified. perFaceStripIdProperty contains the result of the greedy stripification afterwards.
+void BenchmarkStripification(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials);
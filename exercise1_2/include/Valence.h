@@ -5,11 +5,17 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include "util/OpenMeshUtils.h"
+#include "util/ThreadPool.h"
+#include "FlatMesh.h"
 
 // The type used for storing the valence histogram
 typedef std::map<unsigned, unsigned> ValenceHistogram;
 
+// Valence histogram with one entry per valence from 0 to the maximum valence
+typedef std::vector<unsigned> DenseValenceHistogram;
+
 // Container storing the custom mesh property handles required for valence computation
 typedef OpenMesh::VPropHandleT<int> VertexValenceProperty;
 // Task 1.2.3: replace "struct{}" with an appropriate OpenMesh property type
@@ -32,3 +38,14 @@ void ComputeVertexFaceValences (HEMesh &m, const VertexValenceProperty valence);
 
 // Computes the vertex valences for the given mesh, using the indicated property to store the results
 void ComputeVertexVertexValences (HEMesh &m, const VertexValenceProperty valence);
+
+// Computes the vertex face valences and the vertex valences of the flat mesh in one parallel pass over its faces
+// with atomic per-vertex counters. The valences are stored per vertex index.
+void ComputeVertexValences (const FlatMesh &m, std::vector<int> &faceValences, std::vector<int> &vertexValences,
+                            nse::util::ThreadPool* pool = nullptr);
+
+// Computes a dense histogram of the valences, each thread counts a part of the vertices into its own histogram
+DenseValenceHistogram ComputeDenseValenceHistogram (const std::vector<int> &valences, nse::util::ThreadPool* pool = nullptr);
+
+// Returns the non-empty entries of a dense histogram
+ValenceHistogram ToValenceHistogram (const DenseValenceHistogram &histogram);
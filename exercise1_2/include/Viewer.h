@@ -7,6 +7,8 @@
 #include <gui/AbstractViewer.h>
 #include <util/OpenMeshUtils.h>
 #include <Valence.h>
+#include <ImplicitSmoothing.h>
+#include <MeshStatistics.h>
 
 
 class Viewer : public nse::gui::AbstractViewer
@@ -24,6 +26,9 @@ private:
 
 	void ColorMeshFromIds();
 
+	//returns the statistics of the current mesh, they are computed on the first call after the mesh has changed
+	const MeshStatistics& Statistics();
+
 	bool hasColors = false;
 
 	nanogui::ComboBox* shadingBtn;
@@ -40,4 +45,11 @@ private:
 	OpenMesh::FPropHandleT<Eigen::Vector4f> faceColorProperty;
 
 	VertexValenceProperty vertexFaceValenceProperty, vertexVertexValenceProperty;
+
+	//cached statistics of polymesh, invalidated by MeshUpdated
+	MeshStatistics meshStatistics;
+	bool meshStatisticsValid = false;
+
+	//keeps the factorization of the implicit smoothing between clicks
+	ImplicitSmoothing implicitSmoothing;
 };
@@ -7,6 +7,8 @@
 #include <vector>
 #include <unordered_map>
 #include <random>
+#include <algorithm>
+#include <OpenMesh/Core/Mesh/Handles.hh>
 
 
 /*
@@ -28,11 +30,14 @@ my_set.remove(2);
 
 int rand_elem2 = my_set.sample(eng); //1 or 6
 
+sample_set of OpenMesh handles (FaceHandle, VertexHandle, ...) use dense_sample_set, which replaces
+the hash map by an array indexed by handle; reserve memory for the number of mesh elements.
 */
 
 
+//sample_set for arbitrary hashable elements
 template <typename T>
-struct sample_set
+struct hashed_sample_set
 {
 	
 	typedef int element_index;
@@ -41,7 +46,7 @@ struct sample_set
 		
 	
 	//create empty set
-	sample_set(){}
+	hashed_sample_set(){}
 	
 	//reserve memory for n elements
 	void reserve(size_t n)
@@ -107,3 +112,88 @@ struct sample_set
 	}
 
 };
+
+
+//sample_set for OpenMesh handles, which are dense integers
+//positions[h.idx()] is the index of h in elements or -1, it grows on demand
+template <typename Handle>
+struct dense_sample_set
+{
+	
+	typedef int element_index;
+	std::vector<Handle> elements;
+	std::vector<element_index> positions;
+	
+	
+	//create empty set
+	dense_sample_set(){}
+	
+	//reserve memory for the handles 0..n-1
+	void reserve(size_t n)
+	{
+		elements.reserve(n);
+		if (positions.size() < n)
+			positions.resize(n, -1);
+	}
+
+	//insert element elem into set
+	void insert(const Handle& elem)
+	{
+		size_t key = (size_t)elem.idx();
+		if (key >= positions.size())
+			positions.resize(std::max(key + 1, 2 * positions.size()), -1);
+		//guard against duplicates
+		if (positions[key] < 0)
+		{
+			positions[key] = (element_index)elements.size();
+			elements.push_back(elem);
+		}
+	}
+
+	//remove element elem from set
+	bool remove(const Handle& elem)
+	{
+		size_t key = (size_t)elem.idx();
+		if (key >= positions.size() || positions[key] < 0)
+			return false;
+
+		element_index i = positions[key];
+		positions[elements.back().idx()] = i;
+		elements[i] = elements.back();
+		elements.pop_back();
+		positions[key] = -1;
+		return true;
+	}
+
+	//draw a sample from set
+	template <typename Engine>
+	const Handle& sample(Engine& eng)
+	{
+		int b = (element_index)(elements.size()-1);
+		std::uniform_int_distribution<int> uniform_dist(0,b);
+		element_index idx = uniform_dist(eng);
+		return elements[idx];
+	}
+	
+	//returns number of elements in set
+	size_t size() const
+	{
+		return elements.size();
+	}
+
+	//returns true if set is empty
+	bool empty() const
+	{
+		return elements.empty();
+	}
+
+};
+
+
+template <typename T>
+struct sample_set : hashed_sample_set<T> {};
+
+template <> struct sample_set<OpenMesh::VertexHandle> : dense_sample_set<OpenMesh::VertexHandle> {};
+template <> struct sample_set<OpenMesh::HalfedgeHandle> : dense_sample_set<OpenMesh::HalfedgeHandle> {};
+template <> struct sample_set<OpenMesh::EdgeHandle> : dense_sample_set<OpenMesh::EdgeHandle> {};
+template <> struct sample_set<OpenMesh::FaceHandle> : dense_sample_set<OpenMesh::FaceHandle> {};
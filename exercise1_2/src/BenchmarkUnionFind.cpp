@@ -0,0 +1,262 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+/*
+Stress test and throughput benchmark of the union-find structures.
+
+usage: BenchmarkUnionFind [elements] [edges] [seed] [max threads] [label file]
+
+Generates a random edge list (default 100M elements and as many edges, half of them between nearby elements, half between
+arbitrary ones) and merges it with the serial nse::util::UnionFind, one Merge() call per edge and with MergeBatch(), and
+with nse::util::ConcurrentUnionFind on 1, 2, 4, ... threads (up to the number of hardware threads by default). Every
+result is compared entry by entry with the serial partition. UnionFind::CompactLabels() is timed on the same thread
+counts. Afterwards, a smaller edge list is merged many times in tiny chunks with all threads to provoke races on the
+same roots. If a label file is given, the serial structure is saved to it and read back with LoadFromFile and
+MapFromFile to time the persistence.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <util/UnionFind.h>
+#include <util/ConcurrentUnionFind.h>
+#include <util/ThreadPool.h>
+
+namespace
+{
+	typedef nse::util::UnionFind::index_t index_t;
+
+	typedef std::pair<index_t, index_t> Edge;
+
+	//the edges of every chunk are drawn from their own generator, so the list does not depend on the number of threads
+	std::vector<Edge> GenerateEdges(size_t numElements, size_t numEdges, unsigned int seed, nse::util::ThreadPool& pool)
+	{
+		const size_t chunkSize = 1 << 16;
+		std::vector<Edge> edges(numEdges);
+		pool.ParallelForChunks(numEdges, chunkSize, [&](size_t begin, size_t end)
+		{
+			std::mt19937 rnd(seed + (unsigned int)(begin / chunkSize));
+			std::uniform_int_distribution<index_t> element(0, (index_t)numElements - 1);
+			std::uniform_int_distribution<index_t> offset(1, 64);
+			for (size_t i = begin; i < end; ++i)
+			{
+				edges[i].first = element(rnd);
+				edges[i].second = (i & 1) ? (index_t)((edges[i].first + offset(rnd)) % numElements) : element(rnd);
+			}
+		});
+		return edges;
+	}
+
+	//returns the smallest entry of the set of every entry, which is the representative that ConcurrentUnionFind ends up with
+	std::vector<index_t> SmallestInSet(nse::util::UnionFind& unionFind)
+	{
+		const index_t none = std::numeric_limits<index_t>::max();
+		std::vector<index_t> smallest(unionFind.size(), none);
+		for (index_t i = 0; i < unionFind.size(); ++i)
+		{
+			index_t root = unionFind.GetRepresentative(i);
+			if (smallest[root] == none)
+				smallest[root] = i;
+		}
+		for (index_t i = 0; i < unionFind.size(); ++i)
+			smallest[i] = smallest[unionFind.GetRepresentative(i)];
+		return smallest;
+	}
+
+	//checks that the labels are dense, induce the expected partition and that the sizes match
+	bool CheckLabels(const std::vector<index_t>& labels, const std::vector<index_t>& sizes, const std::vector<index_t>& expected)
+	{
+		const index_t none = std::numeric_limits<index_t>::max();
+		std::vector<index_t> labelOfSet(expected.size(), none), setOfLabel(sizes.size(), none), counts(sizes.size(), 0);
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			if (labels[i] >= sizes.size())
+				return false;
+			if (labelOfSet[expected[i]] == none && setOfLabel[labels[i]] == none)
+			{
+				labelOfSet[expected[i]] = labels[i];
+				setOfLabel[labels[i]] = expected[i];
+			}
+			if (labelOfSet[expected[i]] != labels[i] || setOfLabel[labels[i]] != expected[i])
+				return false;
+			++counts[labels[i]];
+		}
+		return counts == sizes && std::find(setOfLabel.begin(), setOfLabel.end(), none) == setOfLabel.end();
+	}
+
+	//returns the number of entries whose representative differs from the expected one
+	size_t CountMismatches(nse::util::ConcurrentUnionFind& unionFind, const std::vector<index_t>& expected, nse::util::ThreadPool& pool)
+	{
+		std::atomic<size_t> mismatches(0);
+		pool.ParallelFor(expected.size(), [&](size_t begin, size_t end, unsigned int)
+		{
+			size_t local = 0;
+			for (size_t i = begin; i < end; ++i)
+				local += unionFind.GetRepresentative((index_t)i) != expected[i];
+			mismatches += local;
+		});
+		return mismatches;
+	}
+
+	void MergeConcurrently(nse::util::ConcurrentUnionFind& unionFind, const std::vector<Edge>& edges, nse::util::ThreadPool& pool, size_t chunkSize = 1 << 14)
+	{
+		pool.ParallelForChunks(edges.size(), chunkSize, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+				unionFind.Merge(edges[i].first, edges[i].second);
+		});
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t numElements = argc > 1 ? std::stoull(argv[1]) : 100000000;
+	size_t numEdges = argc > 2 ? std::stoull(argv[2]) : numElements;
+	unsigned int seed = argc > 3 ? (unsigned int)std::stoul(argv[3]) : 1;
+	unsigned int maxThreads = argc > 4 ? (unsigned int)std::stoul(argv[4]) : std::thread::hardware_concurrency();
+	maxThreads = std::max(1u, maxThreads);
+	if (numElements == 0 || numElements > std::numeric_limits<index_t>::max())
+	{
+		std::cerr << "usage: " << argv[0] << " [elements] [edges] [seed] [max threads] [label file]" << std::endl
+			<< "The number of elements must be between 1 and " << std::numeric_limits<index_t>::max() << "." << std::endl;
+		return 1;
+	}
+
+	typedef std::chrono::high_resolution_clock Clock;
+	auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+	auto mergesPerSecond = [&](double time) { return time > 0 ? numEdges / time : 0; };
+
+	std::cout << "Generating " << numEdges << " edges between " << numElements << " elements .." << std::endl;
+	auto edges = GenerateEdges(numElements, numEdges, seed, *nse::util::ThreadPool::Instance());
+
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	bool passed = true;
+	nse::util::UnionFind serial;
+	serial.AddItems(numElements);
+	auto timeStart = Clock::now();
+	for (auto& e : edges)
+		serial.Merge(e.first, e.second);
+	double serialTime = seconds(Clock::now() - timeStart);
+	std::cout << "Serial UnionFind: " << serialTime << " s (" << mergesPerSecond(serialTime) << " merges/s)" << std::endl;
+
+	auto expected = SmallestInSet(serial);
+
+	{
+		nse::util::UnionFind batched;
+		batched.AddItems(numElements);
+		timeStart = Clock::now();
+		batched.MergeBatch(edges);
+		double batchTime = seconds(Clock::now() - timeStart);
+		bool equal = SmallestInSet(batched) == expected;
+		passed &= equal;
+		std::cout << "Serial UnionFind::MergeBatch: " << batchTime << " s (" << mergesPerSecond(batchTime) << " merges/s, speedup "
+			<< (batchTime > 0 ? serialTime / batchTime : 0) << " over Merge), " << (equal ? "same" : "DIFFERENT") << " partition" << std::endl;
+	}
+
+	//SmallestInSet has compressed all paths, every run labels the same structure
+	std::cout << "UnionFind::CompactLabels:" << std::endl;
+	for (auto threads : threadCounts)
+	{
+		nse::util::ThreadPool pool(threads);
+		std::vector<index_t> labels, sizes;
+		timeStart = Clock::now();
+		size_t numSets = serial.CompactLabels(labels, sizes, &pool);
+		double time = seconds(Clock::now() - timeStart);
+		bool valid = CheckLabels(labels, sizes, expected);
+		passed &= valid;
+		std::cout << "  " << threads << " threads: " << time << " s (" << (time > 0 ? numElements / time : 0) << " entries/s), "
+			<< numSets << " sets, " << (valid ? "valid" : "INVALID") << " labels" << std::endl;
+	}
+	if (argc > 5)
+	{
+		try
+		{
+			timeStart = Clock::now();
+			serial.SaveToFile(argv[5]);
+			double saveTime = seconds(Clock::now() - timeStart);
+
+			nse::util::UnionFind loaded;
+			timeStart = Clock::now();
+			loaded.LoadFromFile(argv[5]);
+			double loadTime = seconds(Clock::now() - timeStart);
+
+			nse::util::UnionFind mapped;
+			timeStart = Clock::now();
+			mapped.MapFromFile(argv[5], false);
+			double mapTime = seconds(Clock::now() - timeStart);
+			size_t mismatches = 0;
+			for (index_t i = 0; i < numElements; ++i)
+				mismatches += expected[i] != expected[mapped.GetRepresentative(i)];
+			double lookupTime = seconds(Clock::now() - timeStart) - mapTime;
+
+			passed &= mismatches == 0;
+			std::cout << "Label file " << argv[5] << ": saved in " << saveTime << " s, loaded in " << loadTime << " s, mapped in "
+				<< mapTime << " s, " << numElements << " mapped lookups in " << lookupTime << " s, " << mismatches << " mismatches" << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+	serial.Clear();
+
+	double singleThreadTime = 0;
+	std::cout << "ConcurrentUnionFind:" << std::endl;
+	for (auto threads : threadCounts)
+	{
+		nse::util::ThreadPool pool(threads);
+		nse::util::ConcurrentUnionFind unionFind(numElements, &pool);
+		timeStart = Clock::now();
+		MergeConcurrently(unionFind, edges, pool);
+		double time = seconds(Clock::now() - timeStart);
+		if (threads == 1)
+			singleThreadTime = time;
+
+		size_t mismatches = CountMismatches(unionFind, expected, pool);
+		passed &= mismatches == 0;
+		std::cout << "  " << threads << " threads: " << time << " s (" << mergesPerSecond(time) << " merges/s, speedup "
+			<< (time > 0 ? singleThreadTime / time : 0) << " over 1 thread, " << (time > 0 ? serialTime / time : 0)
+			<< " over serial), " << mismatches << " mismatches" << std::endl;
+	}
+
+	//many small rounds in tiny chunks, such that the threads keep racing for the same roots
+	const size_t contentionElements = 1 << 16, contentionEdges = 1 << 16;
+	const int contentionRounds = 100;
+	auto contentionEdgeList = GenerateEdges(contentionElements, contentionEdges, seed, *nse::util::ThreadPool::Instance());
+	nse::util::UnionFind contentionSerial;
+	contentionSerial.AddItems(contentionElements);
+	for (auto& e : contentionEdgeList)
+		contentionSerial.Merge(e.first, e.second);
+	auto contentionExpected = SmallestInSet(contentionSerial);
+
+	nse::util::ThreadPool pool(maxThreads);
+	size_t contentionMismatches = 0;
+	for (int round = 0; round < contentionRounds; ++round)
+	{
+		nse::util::ConcurrentUnionFind unionFind(contentionElements, &pool);
+		MergeConcurrently(unionFind, contentionEdgeList, pool, 64);
+		contentionMismatches += CountMismatches(unionFind, contentionExpected, pool);
+	}
+	passed &= contentionMismatches == 0;
+	std::cout << "Contention test (" << contentionRounds << " rounds of " << contentionEdges << " merges on " << contentionElements
+		<< " elements with " << maxThreads << " threads): " << contentionMismatches << " mismatches" << std::endl;
+
+	std::cout << (passed ? "All results match the serial union-find." : "ERROR: results differ from the serial union-find.") << std::endl;
+	return passed ? 0 : 1;
+}
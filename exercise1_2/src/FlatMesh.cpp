@@ -0,0 +1,45 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "FlatMesh.h"
+
+FlatMesh::FlatMesh(const HEMesh& m)
+{
+	size_t n = m.n_vertices();
+	x.resize(n);
+	y.resize(n);
+	z.resize(n);
+	for (auto v : m.vertices())
+	{
+		auto& p = m.point(v);
+		x[v.idx()] = p[0];
+		y[v.idx()] = p[1];
+		z[v.idx()] = p[2];
+	}
+
+	faceOffsets.resize(m.n_faces() + 1);
+	faceVertices.reserve(m.n_halfedges() / 2);
+	ownsEdge.reserve(m.n_halfedges() / 2);
+	triangles.reserve(3 * m.n_faces());
+	for (auto f : m.faces())
+	{
+		uint32_t begin = (uint32_t)faceVertices.size();
+		faceOffsets[f.idx()] = begin;
+		for (auto h : m.fh_range(f))
+		{
+			faceVertices.push_back(m.from_vertex_handle(h).idx());
+			//interior edges are owned by the face of the halfedge with the smaller index
+			auto opposite = m.opposite_halfedge_handle(h);
+			ownsEdge.push_back(h.idx() < opposite.idx() || m.is_boundary(opposite));
+		}
+		uint32_t end = (uint32_t)faceVertices.size();
+		for (uint32_t i = begin + 1; i + 1 < end; ++i)
+		{
+			triangles.push_back(faceVertices[begin]);
+			triangles.push_back(faceVertices[i]);
+			triangles.push_back(faceVertices[i + 1]);
+		}
+	}
+	faceOffsets[m.n_faces()] = (uint32_t)faceVertices.size();
+}
@@ -0,0 +1,225 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+/*
+Generates a reproducible suite of synthetic benchmark meshes.
+
+usage: GenerateBenchmarkMeshes <output directory> [triangles per mesh] [seed]
+
+Every mesh is written as an indexed triangle file (see nse::util::IndexedTriangleWriter) with roughly the given number
+of triangles (default 2^20):
+  sphere.itri      icosahedron subdivided by edge midpoints, projected onto the unit sphere
+  tori.itri        regular grid of small tori, a mesh with very many shells
+  noisy_scan.itri  high resolution torus with noise along the vertex normals, like a scanned surface
+  degenerate.itri  subdivided sphere where a third of the vertices is moved onto a neighbor, many zero-area triangles
+The same size and seed (default 1) always produce the same files, such that the smoothing, shell extraction and
+spatial data structure benchmarks can run on identical inputs. The files can be loaded in the viewers and read by
+StreamShells.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+
+#include <util/IndexedTriangleFile.h>
+
+#include "Primitives.h"
+#include "FlatMesh.h"
+#include "Noise.h"
+
+namespace
+{
+	//vertex positions as x, y, z triples and three vertex indices per triangle, the layout of the output files
+	struct TriangleSoup
+	{
+		std::vector<float> xyz;
+		std::vector<uint32_t> triangles;
+
+		size_t NumVertices() const { return xyz.size() / 3; }
+		size_t NumTriangles() const { return triangles.size() / 3; }
+	};
+
+	//copies the positions and the fan triangulation of a flat mesh, translated by offset
+	void AppendFlatMesh(const FlatMesh& flat, const OpenMesh::Vec3f& offset, TriangleSoup& soup)
+	{
+		uint32_t base = (uint32_t)soup.NumVertices();
+		for (size_t v = 0; v < flat.NumVertices(); ++v)
+		{
+			soup.xyz.push_back(flat.x[v] + offset[0]);
+			soup.xyz.push_back(flat.y[v] + offset[1]);
+			soup.xyz.push_back(flat.z[v] + offset[2]);
+		}
+		for (auto i : flat.triangles)
+			soup.triangles.push_back(base + i);
+	}
+
+	//icosahedron with levels midpoint subdivisions, all vertices are projected onto the unit sphere (20 * 4^levels triangles)
+	TriangleSoup CreateSubdividedSphere(int levels)
+	{
+		HEMesh icosahedron;
+		CreateIcosahedron(icosahedron, 1);
+		TriangleSoup soup;
+		AppendFlatMesh(FlatMesh(icosahedron), OpenMesh::Vec3f(0, 0, 0), soup);
+
+		for (int level = 0; level < levels; ++level)
+		{
+			//every edge gets a single midpoint vertex, which is shared by its two triangles
+			std::unordered_map<uint64_t, uint32_t> midpoints;
+			midpoints.reserve(soup.triangles.size());
+			auto midpoint = [&](uint32_t a, uint32_t b)
+			{
+				uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+				auto it = midpoints.find(key);
+				if (it != midpoints.end())
+					return it->second;
+				OpenMesh::Vec3f p(soup.xyz[3 * a] + soup.xyz[3 * b], soup.xyz[3 * a + 1] + soup.xyz[3 * b + 1], soup.xyz[3 * a + 2] + soup.xyz[3 * b + 2]);
+				p.normalize();
+				uint32_t index = (uint32_t)soup.NumVertices();
+				soup.xyz.insert(soup.xyz.end(), { p[0], p[1], p[2] });
+				midpoints.emplace(key, index);
+				return index;
+			};
+
+			std::vector<uint32_t> subdivided;
+			subdivided.reserve(4 * soup.triangles.size());
+			for (size_t t = 0; t < soup.triangles.size(); t += 3)
+			{
+				uint32_t a = soup.triangles[t], b = soup.triangles[t + 1], c = soup.triangles[t + 2];
+				uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+				subdivided.insert(subdivided.end(), { a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca });
+			}
+			soup.triangles.swap(subdivided);
+		}
+		return soup;
+	}
+
+	//count x count tori which do not touch each other, their centers form a grid in the xy-plane
+	TriangleSoup CreateTorusGrid(int count, int nsides, int rings)
+	{
+		const float r = 0.1f, R = 0.3f;
+		FlatMesh torus;
+		CreateTorus(torus, r, R, nsides, rings);
+		TriangleSoup soup;
+		soup.xyz.reserve(3 * count * count * torus.NumVertices());
+		soup.triangles.reserve(count * count * torus.triangles.size());
+		for (int i = 0; i < count; ++i)
+			for (int j = 0; j < count; ++j)
+				AppendFlatMesh(torus, OpenMesh::Vec3f(i * 3 * R, j * 3 * R, 0), soup);
+		return soup;
+	}
+
+	//torus with seeded noise along the vertex normals (see AddNoise)
+	TriangleSoup CreateNoisyScan(int nsides, int rings, unsigned int seed)
+	{
+		const float r = 0.4f, R = 1.0f;
+		FlatMesh flat;
+		CreateTorus(flat, r, R, nsides, rings);
+		HEMesh m;
+		ToHEMesh(flat, m);
+		//CreateTorus builds the torus in the xz-plane
+		AddNoise(m, Eigen::AlignedBox3f(Eigen::Vector3f(-R - r, -r, -R - r), Eigen::Vector3f(R + r, r, R + r)), seed);
+		TriangleSoup soup;
+		AppendFlatMesh(FlatMesh(m), OpenMesh::Vec3f(0, 0, 0), soup);
+		return soup;
+	}
+
+	//subdivided sphere where every vertex is moved onto one of its neighbors with probability 1/3
+	//the connectivity stays valid, but there are many zero-length edges and zero-area triangles
+	TriangleSoup CreateDegenerateSphere(int levels, unsigned int seed)
+	{
+		TriangleSoup soup = CreateSubdividedSphere(levels);
+		std::vector<uint32_t> neighbor(soup.NumVertices());
+		for (size_t t = 0; t < soup.triangles.size(); t += 3)
+			for (int i = 0; i < 3; ++i)
+				neighbor[soup.triangles[t + i]] = soup.triangles[t + (i + 1) % 3];
+
+		const std::vector<float> original = soup.xyz;
+		std::mt19937 rnd(seed);
+		std::uniform_int_distribution<int> collapse(0, 2);
+		for (size_t v = 0; v < soup.NumVertices(); ++v)
+		{
+			if (collapse(rnd) != 0)
+				continue;
+			std::copy_n(&original[3 * neighbor[v]], 3, &soup.xyz[3 * v]);
+		}
+		return soup;
+	}
+
+	bool WriteSoup(const std::string& path, const TriangleSoup& soup)
+	{
+		nse::util::IndexedTriangleWriter writer;
+		if (!writer.Open(path.c_str()))
+			return false;
+		writer.WriteVertices(soup.xyz.data(), soup.NumVertices());
+		writer.WriteTriangles(soup.triangles.data(), soup.NumTriangles());
+		return writer.Close();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: " << argv[0] << " <output directory> [triangles per mesh] [seed]" << std::endl;
+		return 1;
+	}
+	std::string directory = argv[1];
+	if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+		directory += '/';
+	double targetTriangles = argc > 2 ? std::max(20.0, (double)std::stoull(argv[2])) : (double)(1 << 20);
+	unsigned int seed = argc > 3 ? (unsigned int)std::stoul(argv[3]) : 1;
+
+	typedef std::chrono::high_resolution_clock Clock;
+	auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+	//resolutions which come closest to the requested number of triangles
+	int sphereLevels = std::max(0, (int)std::lround(std::log(targetTriangles / 20) / std::log(4.0)));
+	const int torusSides = 16, torusRings = 16;
+	int torusCount = std::max(1, (int)std::lround(std::sqrt(targetTriangles / (2 * torusSides * torusRings))));
+	//the scan torus has four times as many rings as sides, 2 * sides * rings triangles
+	int scanSides = std::max(3, (int)std::lround(std::sqrt(targetTriangles / 8)));
+
+	struct SuiteEntry
+	{
+		const char* name;
+		std::function<TriangleSoup()> create;
+	};
+	std::vector<SuiteEntry> suite =
+	{
+		{ "sphere.itri", [&]() { return CreateSubdividedSphere(sphereLevels); } },
+		{ "tori.itri", [&]() { return CreateTorusGrid(torusCount, torusSides, torusRings); } },
+		{ "noisy_scan.itri", [&]() { return CreateNoisyScan(scanSides, 4 * scanSides, seed); } },
+		{ "degenerate.itri", [&]() { return CreateDegenerateSphere(sphereLevels, seed + 1); } },
+	};
+
+	std::cout << "Generating the benchmark meshes with seed " << seed << " in " << directory << std::endl;
+	for (auto& entry : suite)
+	{
+		auto timeStart = Clock::now();
+		TriangleSoup soup = entry.create();
+		double generateTime = seconds(Clock::now() - timeStart);
+
+		std::string path = directory + entry.name;
+		timeStart = Clock::now();
+		if (!WriteSoup(path, soup))
+		{
+			std::cerr << "Cannot write " << path << std::endl;
+			return 1;
+		}
+		double writeTime = seconds(Clock::now() - timeStart);
+
+		size_t bytes = sizeof(nse::util::IndexedTriangleFileHeader) + soup.xyz.size() * sizeof(float) + soup.triangles.size() * sizeof(uint32_t);
+		std::cout << "  " << entry.name << ": " << soup.NumVertices() << " vertices, " << soup.NumTriangles() << " triangles, "
+			<< bytes / (1024.0 * 1024.0) << " MiB (generated in " << generateTime << " s, written in " << writeTime << " s)" << std::endl;
+	}
+
+	return 0;
+}
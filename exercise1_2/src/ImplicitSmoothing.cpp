@@ -0,0 +1,121 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "ImplicitSmoothing.h"
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+ImplicitSmoothing::ImplicitSmoothing()
+{
+	Reset();
+}
+
+void ImplicitSmoothing::Reset()
+{
+	matrix.resize(0, 0);
+	valences.resize(0);
+	numVertices = numHalfedges = 0;
+	connectivityHash = 0;
+	factorizedLambda = 0.0f;
+	analyzed = factorized = false;
+	analysisTime = factorizationTime = solveTime = 0.0;
+}
+
+uint64_t ImplicitSmoothing::ConnectivityHash(const HEMesh& m)
+{
+	//FNV-1a over the target vertices of all halfedges
+	uint64_t hash = 14695981039346656037ull;
+	for (auto h : m.halfedges())
+	{
+		hash ^= (uint64_t)(uint32_t)m.to_vertex_handle(h).idx();
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void ImplicitSmoothing::AssembleMatrix(const HEMesh& m, float lambda)
+{
+	size_t n = m.n_vertices();
+	valences.resize(n);
+	std::vector<Eigen::Triplet<double>> triplets;
+	triplets.reserve(n + m.n_halfedges());
+	for (auto v : m.vertices())
+	{
+		int valence = 0;
+		for (auto vn : m.vv_range(v))
+		{
+			triplets.emplace_back(v.idx(), vn.idx(), -(double)lambda);
+			++valence;
+		}
+		valences[v.idx()] = valence > 0 ? valence : 1;
+		triplets.emplace_back(v.idx(), v.idx(), (1.0 + lambda) * valences[v.idx()]);
+	}
+	matrix.resize(n, n);
+	matrix.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+bool ImplicitSmoothing::SmoothUniform(HEMesh& m, float lambda)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	analysisTime = factorizationTime = solveTime = 0.0;
+
+	uint64_t hash = ConnectivityHash(m);
+	if (m.n_vertices() != numVertices || m.n_halfedges() != numHalfedges || hash != connectivityHash)
+	{
+		analyzed = factorized = false;
+		numVertices = m.n_vertices();
+		numHalfedges = m.n_halfedges();
+		connectivityHash = hash;
+	}
+
+	if (!factorized || lambda != factorizedLambda)
+	{
+		AssembleMatrix(m, lambda);
+		factorized = false;
+
+		if (!analyzed)
+		{
+			auto timeStart = Clock::now();
+			solver.analyzePattern(matrix);
+			analysisTime = milliseconds(Clock::now() - timeStart);
+			analyzed = true;
+		}
+
+		auto timeStart = Clock::now();
+		solver.factorize(matrix);
+		factorizationTime = milliseconds(Clock::now() - timeStart);
+		if (solver.info() != Eigen::Success)
+		{
+			std::cerr << "Implicit smoothing: factorization of the system matrix failed." << std::endl;
+			Reset();
+			return false;
+		}
+		factorized = true;
+		factorizedLambda = lambda;
+	}
+
+	auto timeStart = Clock::now();
+	Eigen::MatrixXd rhs(numVertices, 3);
+	for (auto v : m.vertices())
+	{
+		auto& p = m.point(v);
+		for (int d = 0; d < 3; ++d)
+			rhs(v.idx(), d) = valences[v.idx()] * p[d];
+	}
+	Eigen::MatrixXd result = solver.solve(rhs);
+	solveTime = milliseconds(Clock::now() - timeStart);
+	if (solver.info() != Eigen::Success)
+	{
+		std::cerr << "Implicit smoothing: solving the system failed." << std::endl;
+		return false;
+	}
+
+	for (auto v : m.vertices())
+		m.set_point(v, OpenMesh::Vec3f((float)result(v.idx(), 0), (float)result(v.idx(), 1), (float)result(v.idx(), 2)));
+	return true;
+}
@@ -0,0 +1,199 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "MeshLaplacian.h"
+
+#include <cmath>
+
+#include "Smoothing.h"
+
+MeshLaplacian::MeshLaplacian(const HEMesh& m, nse::util::ThreadPool* pool)
+{
+	SetThreadPool(pool);
+
+	size_t n = m.n_vertices();
+	offsets.resize(n + 1);
+	isBoundary.resize(n);
+	neighbors.reserve(m.n_halfedges());
+	entryEdges.reserve(m.n_halfedges());
+	for (auto v : m.vertices())
+	{
+		offsets[v.idx()] = (uint32_t)neighbors.size();
+		isBoundary[v.idx()] = m.is_boundary(v);
+		for (auto h : m.voh_range(v))
+		{
+			neighbors.push_back(m.to_vertex_handle(h).idx());
+			entryEdges.push_back(m.edge_handle(h).idx());
+		}
+	}
+	offsets[n] = (uint32_t)neighbors.size();
+
+	edgeVertices.resize(4 * m.n_edges());
+	for (auto e : m.edges())
+	{
+		uint32_t* ev = &edgeVertices[4 * e.idx()];
+		auto h0 = m.halfedge_handle(e, 0);
+		auto h1 = m.halfedge_handle(e, 1);
+		ev[0] = m.from_vertex_handle(h0).idx();
+		ev[1] = m.to_vertex_handle(h0).idx();
+		ev[2] = m.is_boundary(h0) ? NoVertex : m.to_vertex_handle(m.next_halfedge_handle(h0)).idx();
+		ev[3] = m.is_boundary(h1) ? NoVertex : m.to_vertex_handle(m.next_halfedge_handle(h1)).idx();
+	}
+	edgeWeights.resize(m.n_edges());
+	weightUpdateInterval = 1;
+	InvalidateWeights();
+
+	x.resize(n); y.resize(n); z.resize(n);
+	nextX.resize(n); nextY.resize(n); nextZ.resize(n);
+	LoadPositions(m);
+}
+
+void MeshLaplacian::SetThreadPool(nse::util::ThreadPool* pool)
+{
+	this->pool = pool != nullptr ? pool : nse::util::ThreadPool::Instance();
+}
+
+void MeshLaplacian::SetWeightUpdateInterval(unsigned int iterations)
+{
+	weightUpdateInterval = iterations > 0 ? iterations : 1;
+}
+
+void MeshLaplacian::LoadPositions(const HEMesh& m)
+{
+	InvalidateWeights();
+	for (auto v : m.vertices())
+	{
+		auto& p = m.point(v);
+		x[v.idx()] = p[0];
+		y[v.idx()] = p[1];
+		z[v.idx()] = p[2];
+	}
+}
+
+void MeshLaplacian::StorePositions(HEMesh& m) const
+{
+	for (auto v : m.vertices())
+		m.set_point(v, Position(v.idx()));
+}
+
+void MeshLaplacian::SmoothUniform(float lambda)
+{
+	pool->ParallelFor(NumVertices(), [&](size_t begin, size_t end, unsigned int)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			OpenMesh::Vec3f avg(0.0f, 0.0f, 0.0f);
+			for (uint32_t k = offsets[i]; k < offsets[i + 1]; ++k)
+				avg += Position(neighbors[k]);
+			int count = (int)(offsets[i + 1] - offsets[i]);
+			if (count > 0)
+				avg /= count;
+
+			OpenMesh::Vec3f p = Position(i);
+			OpenMesh::Vec3f newP = p + lambda * (avg - p);
+			nextX[i] = newP[0];
+			nextY[i] = newP[1];
+			nextZ[i] = newP[2];
+		}
+	});
+	x.swap(nextX);
+	y.swap(nextY);
+	z.swap(nextZ);
+}
+
+void MeshLaplacian::ComputeCotanWeights()
+{
+	pool->ParallelFor(edgeWeights.size(), [&](size_t begin, size_t end, unsigned int)
+	{
+		SmoothingIssueCounts issues;
+		for (size_t e = begin; e < end; ++e)
+		{
+			const uint32_t* ev = &edgeVertices[4 * e];
+			//boundary edges are only incident to boundary vertices, which do not use weights
+			if (ev[2] == NoVertex || ev[3] == NoVertex)
+			{
+				edgeWeights[e] = std::nanf("");
+				continue;
+			}
+			OpenMesh::Vec3f p0 = Position(ev[0]);
+			OpenMesh::Vec3f p1 = Position(ev[1]);
+			float cotAlpha = cotangent(Position(ev[2]), p0, p1, issues);
+			float cotBeta = cotangent(Position(ev[3]), p0, p1, issues);
+			if (std::isnan(cotAlpha) || std::isnan(cotBeta))
+			{
+				issues.Count(SmoothingIssue::InvalidCotangent);
+				edgeWeights[e] = std::nanf("");
+				continue;
+			}
+			float weight = cotAlpha + cotBeta;
+			if (std::isnan(weight) || std::isinf(weight))
+			{
+				issues.Count(SmoothingIssue::InvalidWeight);
+				weight = std::nanf("");
+			}
+			edgeWeights[e] = weight;
+		}
+		diagnostics.Add(issues);
+	});
+}
+
+void MeshLaplacian::SmoothCotan(float lambda)
+{
+	if (iterationsSinceWeightUpdate >= weightUpdateInterval)
+	{
+		ComputeCotanWeights();
+		iterationsSinceWeightUpdate = 0;
+	}
+	++iterationsSinceWeightUpdate;
+
+	pool->ParallelFor(NumVertices(), [&](size_t begin, size_t end, unsigned int)
+	{
+		SmoothingIssueCounts issues;
+		for (size_t i = begin; i < end; ++i)
+		{
+			OpenMesh::Vec3f p0 = Position(i);
+			OpenMesh::Vec3f newP = p0;
+			if (!isBoundary[i])
+			{
+				OpenMesh::Vec3f laplacian(0.0f, 0.0f, 0.0f);
+				float weightSum = 0.0f;
+				for (uint32_t k = offsets[i]; k < offsets[i + 1]; ++k)
+				{
+					float weight = edgeWeights[entryEdges[k]];
+					if (std::isnan(weight))
+						continue;
+					laplacian += weight * (Position(neighbors[k]) - p0);
+					weightSum += weight;
+				}
+
+				if (weightSum < 1e-6f)
+				{
+					issues.Count(SmoothingIssue::SmallWeightSum);
+					weightSum = 1e-6f;
+				}
+				laplacian /= (2.0f * weightSum);
+
+				if (std::isnan(laplacian[0]) || std::isnan(laplacian[1]) || std::isnan(laplacian[2]))
+				{
+					issues.Count(SmoothingIssue::InvalidLaplacian);
+					laplacian = OpenMesh::Vec3f(0.0f, 0.0f, 0.0f);
+				}
+
+				newP = p0 + lambda * laplacian;
+				if (std::isnan(newP[0]) || std::isnan(newP[1]) || std::isnan(newP[2]))
+				{
+					issues.Count(SmoothingIssue::InvalidPosition);
+					newP = p0;
+				}
+			}
+			nextX[i] = newP[0];
+			nextY[i] = newP[1];
+			nextZ[i] = newP[2];
+		}
+		diagnostics.Add(issues);
+	});
+	x.swap(nextX);
+	y.swap(nextY);
+	z.swap(nextZ);
+}
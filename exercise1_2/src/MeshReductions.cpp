@@ -0,0 +1,278 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "MeshReductions.h"
+
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "SurfaceArea.h"
+#include "Volume.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define MESH_REDUCTIONS_AVX2 1
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+	#define MESH_REDUCTIONS_AVX2 1
+	#define AVX2_TARGET
+	#include <immintrin.h>
+	#include <intrin.h>
+#endif
+
+namespace
+{
+	enum class TriangleQuantity
+	{
+		Area,
+		//six times the signed volume of the tetrahedron of the triangle and the origin
+		ScaledSignedVolume
+	};
+
+	//number of triangles whose sum is computed by a single thread
+	const size_t BlockSize = 4096;
+
+	//value of triangle t in double precision, the scalar counterpart of the AVX2 kernel
+	double TriangleValue(const FlatMesh& m, size_t t, TriangleQuantity quantity)
+	{
+		const uint32_t* tri = &m.triangles[3 * t];
+		double x0 = m.x[tri[0]], y0 = m.y[tri[0]], z0 = m.z[tri[0]];
+		double x1 = m.x[tri[1]], y1 = m.y[tri[1]], z1 = m.z[tri[1]];
+		double x2 = m.x[tri[2]], y2 = m.y[tri[2]], z2 = m.z[tri[2]];
+		if (quantity == TriangleQuantity::Area)
+		{
+			double ux = x1 - x0, uy = y1 - y0, uz = z1 - z0;
+			double vx = x2 - x0, vy = y2 - y0, vz = z2 - z0;
+			double cx = uy * vz - uz * vy;
+			double cy = uz * vx - ux * vz;
+			double cz = ux * vy - uy * vx;
+			return 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+		}
+		double cx = y1 * z2 - z1 * y2;
+		double cy = z1 * x2 - x1 * z2;
+		double cz = x1 * y2 - y1 * x2;
+		return x0 * cx + y0 * cy + z0 * cz;
+	}
+
+	//sums the triangles [begin, end) in four interleaved accumulators like the AVX2 kernel
+	double SumBlockScalar(const FlatMesh& m, size_t begin, size_t end, TriangleQuantity quantity)
+	{
+		double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+		size_t t = begin;
+		for (; t + 4 <= end; t += 4)
+			for (int lane = 0; lane < 4; ++lane)
+				lanes[lane] += TriangleValue(m, t + lane, quantity);
+		double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		for (; t < end; ++t)
+			sum += TriangleValue(m, t, quantity);
+		return sum;
+	}
+
+#ifdef MESH_REDUCTIONS_AVX2
+	//loads the coordinates of four vertices and converts them to double
+	AVX2_TARGET inline __m256d GatherCoordinates(const float* coordinates, __m128i indices)
+	{
+		return _mm256_cvtps_pd(_mm_i32gather_ps(coordinates, indices, 4));
+	}
+
+	AVX2_TARGET double SumBlockAVX2(const FlatMesh& m, size_t begin, size_t end, TriangleQuantity quantity)
+	{
+		const int* tri = reinterpret_cast<const int*>(m.triangles.data());
+		const __m128i stride = _mm_setr_epi32(0, 3, 6, 9);
+		__m256d sum = _mm256_setzero_pd();
+		size_t t = begin;
+		for (; t + 4 <= end; t += 4)
+		{
+			const int* base = tri + 3 * t;
+			__m128i i0 = _mm_i32gather_epi32(base, stride, 4);
+			__m128i i1 = _mm_i32gather_epi32(base + 1, stride, 4);
+			__m128i i2 = _mm_i32gather_epi32(base + 2, stride, 4);
+			__m256d x0 = GatherCoordinates(m.x.data(), i0), y0 = GatherCoordinates(m.y.data(), i0), z0 = GatherCoordinates(m.z.data(), i0);
+			__m256d x1 = GatherCoordinates(m.x.data(), i1), y1 = GatherCoordinates(m.y.data(), i1), z1 = GatherCoordinates(m.z.data(), i1);
+			__m256d x2 = GatherCoordinates(m.x.data(), i2), y2 = GatherCoordinates(m.y.data(), i2), z2 = GatherCoordinates(m.z.data(), i2);
+			__m256d value;
+			if (quantity == TriangleQuantity::Area)
+			{
+				__m256d ux = _mm256_sub_pd(x1, x0), uy = _mm256_sub_pd(y1, y0), uz = _mm256_sub_pd(z1, z0);
+				__m256d vx = _mm256_sub_pd(x2, x0), vy = _mm256_sub_pd(y2, y0), vz = _mm256_sub_pd(z2, z0);
+				__m256d cx = _mm256_sub_pd(_mm256_mul_pd(uy, vz), _mm256_mul_pd(uz, vy));
+				__m256d cy = _mm256_sub_pd(_mm256_mul_pd(uz, vx), _mm256_mul_pd(ux, vz));
+				__m256d cz = _mm256_sub_pd(_mm256_mul_pd(ux, vy), _mm256_mul_pd(uy, vx));
+				__m256d sqrNorm = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy)), _mm256_mul_pd(cz, cz));
+				value = _mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_sqrt_pd(sqrNorm));
+			}
+			else
+			{
+				__m256d cx = _mm256_sub_pd(_mm256_mul_pd(y1, z2), _mm256_mul_pd(z1, y2));
+				__m256d cy = _mm256_sub_pd(_mm256_mul_pd(z1, x2), _mm256_mul_pd(x1, z2));
+				__m256d cz = _mm256_sub_pd(_mm256_mul_pd(x1, y2), _mm256_mul_pd(y1, x2));
+				value = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x0, cx), _mm256_mul_pd(y0, cy)), _mm256_mul_pd(z0, cz));
+			}
+			sum = _mm256_add_pd(sum, value);
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, sum);
+		double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		for (; t < end; ++t)
+			result += TriangleValue(m, t, quantity);
+		return result;
+	}
+#endif
+
+	//adds the values pairwise, which keeps the rounding error logarithmic in their number
+	double PairwiseSum(const double* values, size_t count)
+	{
+		if (count <= 8)
+		{
+			double sum = 0.0;
+			for (size_t i = 0; i < count; ++i)
+				sum += values[i];
+			return sum;
+		}
+		size_t half = count / 2;
+		return PairwiseSum(values, half) + PairwiseSum(values + half, count - half);
+	}
+
+	double SumTriangles(const FlatMesh& m, TriangleQuantity quantity, bool useSimd, nse::util::ThreadPool* pool)
+	{
+		if (pool == nullptr)
+			pool = nse::util::ThreadPool::Instance();
+		bool simd = useSimd && HasAVX2();
+
+		size_t numTriangles = m.NumTriangles();
+		size_t numBlocks = (numTriangles + BlockSize - 1) / BlockSize;
+		std::vector<double> blockSums(numBlocks);
+		pool->ParallelFor(numBlocks, [&](size_t begin, size_t end, unsigned int)
+		{
+			for (size_t b = begin; b < end; ++b)
+			{
+				size_t first = b * BlockSize;
+				size_t last = std::min(numTriangles, first + BlockSize);
+#ifdef MESH_REDUCTIONS_AVX2
+				if (simd)
+				{
+					blockSums[b] = SumBlockAVX2(m, first, last, quantity);
+					continue;
+				}
+#endif
+				blockSums[b] = SumBlockScalar(m, first, last, quantity);
+			}
+		});
+		return PairwiseSum(blockSums.data(), numBlocks);
+	}
+
+	long double SumTrianglesReference(const FlatMesh& m, TriangleQuantity quantity)
+	{
+		long double sum = 0.0L;
+		for (size_t t = 0; t < m.NumTriangles(); ++t)
+		{
+			const uint32_t* tri = &m.triangles[3 * t];
+			long double x0 = m.x[tri[0]], y0 = m.y[tri[0]], z0 = m.z[tri[0]];
+			long double x1 = m.x[tri[1]], y1 = m.y[tri[1]], z1 = m.z[tri[1]];
+			long double x2 = m.x[tri[2]], y2 = m.y[tri[2]], z2 = m.z[tri[2]];
+			if (quantity == TriangleQuantity::Area)
+			{
+				long double ux = x1 - x0, uy = y1 - y0, uz = z1 - z0;
+				long double vx = x2 - x0, vy = y2 - y0, vz = z2 - z0;
+				long double cx = uy * vz - uz * vy;
+				long double cy = uz * vx - ux * vz;
+				long double cz = ux * vy - uy * vx;
+				sum += 0.5L * std::sqrt(cx * cx + cy * cy + cz * cz);
+			}
+			else
+				sum += x0 * (y1 * z2 - z1 * y2) + y0 * (z1 * x2 - x1 * z2) + z0 * (x1 * y2 - y1 * x2);
+		}
+		return sum;
+	}
+}
+
+bool HasAVX2()
+{
+#if defined(MESH_REDUCTIONS_AVX2) && (defined(__GNUC__) || defined(__clang__))
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+#elif defined(MESH_REDUCTIONS_AVX2)
+	int info[4];
+	__cpuid(info, 1);
+	//the operating system has to save the AVX registers
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+double ComputeSurfaceArea(const FlatMesh& m, bool useSimd, nse::util::ThreadPool* pool)
+{
+	return SumTriangles(m, TriangleQuantity::Area, useSimd, pool);
+}
+
+double ComputeVolume(const FlatMesh& m, bool useSimd, nse::util::ThreadPool* pool)
+{
+	return std::abs(SumTriangles(m, TriangleQuantity::ScaledSignedVolume, useSimd, pool)) / 6.0;
+}
+
+long double ComputeSurfaceAreaReference(const FlatMesh& m)
+{
+	return SumTrianglesReference(m, TriangleQuantity::Area);
+}
+
+long double ComputeVolumeReference(const FlatMesh& m)
+{
+	return std::abs(SumTrianglesReference(m, TriangleQuantity::ScaledSignedVolume)) / 6.0L;
+}
+
+void BenchmarkAreaAndVolume(const HEMesh& m)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+	//every measurement is repeated and the fastest run is reported
+	const int repetitions = 5;
+
+	auto timeStart = Clock::now();
+	FlatMesh flat(m);
+	double conversionTime = seconds(Clock::now() - timeStart);
+
+	long double referenceArea = ComputeSurfaceAreaReference(flat);
+	long double referenceVolume = ComputeVolumeReference(flat);
+
+	std::cout << std::scientific << std::setprecision(3) << "Area and volume benchmark for " << m.n_faces() << " faces ("
+		<< flat.NumTriangles() << " triangles), " << nse::util::ThreadPool::Instance()->NumThreads() << " threads, AVX2 "
+		<< (HasAVX2() ? "available" : "not available") << ":" << std::endl
+		<< " - conversion to flat mesh took " << conversionTime * 1000 << "ms" << std::endl
+		<< " - long double reference: area " << (double)referenceArea << ", volume " << (double)referenceVolume << std::endl;
+
+	auto report = [&](const char* name, const std::function<double(bool)>& compute)
+	{
+		double bestTime[2] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+		double result[2] = { 0.0, 0.0 };
+		for (int r = 0; r < repetitions; ++r)
+		{
+			for (int volume = 0; volume < 2; ++volume)
+			{
+				auto start = Clock::now();
+				result[volume] = compute(volume != 0);
+				bestTime[volume] = std::min(bestTime[volume], seconds(Clock::now() - start));
+			}
+		}
+		std::cout << " - " << name << ": area " << m.n_faces() / bestTime[0] << " faces/s (relative error "
+			<< (double)std::abs((result[0] - referenceArea) / referenceArea) << "), volume " << m.n_faces() / bestTime[1]
+			<< " faces/s (relative error " << (double)std::abs((result[1] - referenceVolume) / referenceVolume) << ")" << std::endl;
+	};
+
+	report("halfedge mesh (float)", [&](bool volume) { return volume ? (double)ComputeVolume(m) : (double)ComputeSurfaceArea(m); });
+	report("flat mesh scalar     ", [&](bool volume) { return volume ? ComputeVolume(flat, false) : ComputeSurfaceArea(flat, false); });
+	if (HasAVX2())
+		report("flat mesh AVX2       ", [&](bool volume) { return volume ? ComputeVolume(flat, true) : ComputeSurfaceArea(flat, true); });
+	std::cout << std::defaultfloat;
+}
@@ -0,0 +1,190 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "MeshStatistics.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+	//number of faces (and vertices) of a block, the blocks do not depend on the number of threads
+	const size_t BlockSize = 4096;
+
+	//partial sums of a block
+	struct Accumulator
+	{
+		double area = 0.0;
+		//six times the signed volume
+		double volume6 = 0.0;
+		//first moments of the volume times 24
+		double first[3] = { 0.0, 0.0, 0.0 };
+		//second moments of the volume times 120 in the order xx, yy, zz, xy, yz, zx
+		double second[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+		float lower[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		float upper[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		size_t numEdges = 0;
+		double edgeLengthSum = 0.0;
+		float minEdgeLength = std::numeric_limits<float>::infinity();
+		float maxEdgeLength = 0.0f;
+
+		//adds the triangle a, b, c and its tetrahedron with the origin
+		void AddTriangle(const OpenMesh::Vec3f& fa, const OpenMesh::Vec3f& fb, const OpenMesh::Vec3f& fc)
+		{
+			Eigen::Vector3d a(fa[0], fa[1], fa[2]), b(fb[0], fb[1], fb[2]), c(fc[0], fc[1], fc[2]);
+			area += 0.5 * (b - a).cross(c - a).norm();
+
+			//volume integrals of the tetrahedron (0, a, b, c)
+			double det = a.dot(b.cross(c));
+			volume6 += det;
+			Eigen::Vector3d sum = a + b + c;
+			for (int i = 0; i < 3; ++i)
+				first[i] += det * sum[i];
+			const int rows[6] = { 0, 1, 2, 0, 1, 2 };
+			const int cols[6] = { 0, 1, 2, 1, 2, 0 };
+			for (int k = 0; k < 6; ++k)
+			{
+				int i = rows[k], j = cols[k];
+				second[k] += det * (a[i] * a[j] + b[i] * b[j] + c[i] * c[j] + sum[i] * sum[j]);
+			}
+		}
+
+		void AddEdge(float length)
+		{
+			++numEdges;
+			edgeLengthSum += length;
+			minEdgeLength = std::min(minEdgeLength, length);
+			maxEdgeLength = std::max(maxEdgeLength, length);
+		}
+
+		void AddVertex(const OpenMesh::Vec3f& p)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				lower[i] = std::min(lower[i], p[i]);
+				upper[i] = std::max(upper[i], p[i]);
+			}
+		}
+
+		void Add(const Accumulator& other)
+		{
+			area += other.area;
+			volume6 += other.volume6;
+			for (int i = 0; i < 3; ++i)
+			{
+				first[i] += other.first[i];
+				lower[i] = std::min(lower[i], other.lower[i]);
+				upper[i] = std::max(upper[i], other.upper[i]);
+			}
+			for (int k = 0; k < 6; ++k)
+				second[k] += other.second[k];
+			numEdges += other.numEdges;
+			edgeLengthSum += other.edgeLengthSum;
+			minEdgeLength = std::min(minEdgeLength, other.minEdgeLength);
+			maxEdgeLength = std::max(maxEdgeLength, other.maxEdgeLength);
+		}
+	};
+}
+
+MeshStatistics ComputeMeshStatistics(const HEMesh& m, nse::util::ThreadPool* pool)
+{
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	size_t numFaces = m.n_faces();
+	size_t numVertices = m.n_vertices();
+	size_t numBlocks = (std::max(numFaces, numVertices) + BlockSize - 1) / BlockSize;
+	std::vector<Accumulator> blocks(numBlocks);
+
+	pool->ParallelFor(numBlocks, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (size_t b = begin; b < end; ++b)
+		{
+			Accumulator& acc = blocks[b];
+			size_t firstFace = b * BlockSize, lastFace = std::min(numFaces, firstFace + BlockSize);
+			for (size_t f = firstFace; f < lastFace; ++f)
+			{
+				auto h0 = m.halfedge_handle(OpenMesh::FaceHandle((int)f));
+				auto& p0 = m.point(m.from_vertex_handle(h0));
+				auto h = h0;
+				do
+				{
+					auto& from = m.point(m.from_vertex_handle(h));
+					auto& to = m.point(m.to_vertex_handle(h));
+					//an edge is counted by the face of its halfedge with the smaller index, boundary edges by their only face
+					auto opposite = m.opposite_halfedge_handle(h);
+					if (h.idx() < opposite.idx() || m.is_boundary(opposite))
+						acc.AddEdge((to - from).length());
+					//fan triangle of the edges which do not touch the first vertex
+					if (h != h0 && m.to_vertex_handle(h) != m.from_vertex_handle(h0))
+						acc.AddTriangle(p0, from, to);
+					h = m.next_halfedge_handle(h);
+				} while (h != h0);
+			}
+
+			size_t firstVertex = b * BlockSize, lastVertex = std::min(numVertices, firstVertex + BlockSize);
+			for (size_t v = firstVertex; v < lastVertex; ++v)
+				acc.AddVertex(m.point(OpenMesh::VertexHandle((int)v)));
+		}
+	});
+
+	//the blocks are added in a fixed order, which makes the result independent of the number of threads
+	Accumulator total;
+	for (auto& block : blocks)
+		total.Add(block);
+
+	MeshStatistics stats;
+	stats.numFaces = numFaces;
+	stats.numEdges = total.numEdges;
+	stats.surfaceArea = total.area;
+	stats.signedVolume = total.volume6 / 6.0;
+	if (total.numEdges > 0)
+	{
+		stats.minEdgeLength = total.minEdgeLength;
+		stats.meanEdgeLength = (float)(total.edgeLengthSum / total.numEdges);
+		stats.maxEdgeLength = total.maxEdgeLength;
+	}
+	if (numVertices > 0)
+	{
+		Eigen::Matrix<float, 3, 2> corners;
+		corners << total.lower[0], total.upper[0], total.lower[1], total.upper[1], total.lower[2], total.upper[2];
+		stats.bbox.expand(corners);
+	}
+
+	if (total.volume6 != 0.0)
+	{
+		stats.centroid = Eigen::Vector3d(total.first[0], total.first[1], total.first[2]) / (4.0 * total.volume6);
+
+		//second moments with respect to the origin, the sign makes them positive for inward-oriented meshes as well
+		double sign = total.volume6 > 0 ? 1.0 : -1.0;
+		Eigen::Matrix3d moments;
+		moments << total.second[0], total.second[3], total.second[5],
+			total.second[3], total.second[1], total.second[4],
+			total.second[5], total.second[4], total.second[2];
+		moments *= sign / 120.0;
+		//parallel axis theorem to move them to the centroid
+		moments -= std::abs(stats.signedVolume) * stats.centroid * stats.centroid.transpose();
+		stats.inertia = moments.trace() * Eigen::Matrix3d::Identity() - moments;
+	}
+	return stats;
+}
+
+std::ostream& operator<<(std::ostream& os, const MeshStatistics& stats)
+{
+	os << "  faces:          " << stats.numFaces << std::endl
+	   << "  edges:          " << stats.numEdges << std::endl
+	   << "  surface area:   " << stats.surfaceArea << std::endl
+	   << "  signed volume:  " << stats.signedVolume << std::endl
+	   << "  centroid:       " << stats.centroid.transpose() << std::endl
+	   << "  inertia tensor: " << stats.inertia.row(0) << std::endl
+	   << "                  " << stats.inertia.row(1) << std::endl
+	   << "                  " << stats.inertia.row(2) << std::endl
+	   << "  bounding box:   " << stats.bbox.min.transpose() << " - " << stats.bbox.max.transpose() << std::endl
+	   << "  edge length:    min " << stats.minEdgeLength << ", mean " << stats.meanEdgeLength << ", max " << stats.maxEdgeLength << std::endl;
+	return os;
+}
@@ -0,0 +1,30 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "Noise.h"
+
+#include <algorithm>
+
+void AddNoise (HEMesh &m, const Eigen::AlignedBox3f& bbox, unsigned int seed)
+{
+	std::mt19937 rnd(seed);
+	std::normal_distribution<float> dist;
+
+	const auto diag = bbox.diagonal();
+	for (auto v : m.vertices())
+	{
+		OpenMesh::Vec3f n;
+		m.calc_vertex_normal_correct(v, n);
+		const float base_diag = std::min(diag.x(), std::min(diag.y(), diag.z())) / 20.f;
+		float base_nb=0, nb_num=0;
+		for (auto vnb : m.vv_range(v))
+		{
+			base_nb += (m.point(v) - m.point(vnb)).norm();
+			nb_num++;
+		}
+		base_nb /= 4.f * nb_num;
+
+		m.point(v) += std::min(base_diag, base_nb) * dist(rnd) * n.normalized();
+	}
+}
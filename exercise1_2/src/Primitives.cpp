@@ -5,6 +5,10 @@
 #include "Primitives.h"
 #include "util/OpenMeshUtils.h"
 
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
 void CreateQuad(HEMesh& mesh)
 {
 	mesh.clear();
@@ -327,3 +331,288 @@ void CreateUnitArrow(HEMesh& mesh, float stem_radius, float head_radius, float s
 			vhandles[1 + (stem_stacks + 1)*slices + (1 + i) % slices]);
 	}
 }
+
+
+//faces of the flat generators, the counts of all faces are known upfront which allows to write them in parallel
+namespace
+{
+	//reserves the arrays of a flat mesh with nv vertices, nTriangleFaces triangles and nQuadFaces quads
+	void AllocateFlatMesh(FlatMesh& mesh, size_t nv, size_t nTriangleFaces, size_t nQuadFaces)
+	{
+		size_t nf = nTriangleFaces + nQuadFaces;
+		size_t nEntries = 3 * nTriangleFaces + 4 * nQuadFaces;
+		mesh.x.resize(nv);
+		mesh.y.resize(nv);
+		mesh.z.resize(nv);
+		mesh.faceOffsets.resize(nf + 1);
+		mesh.faceVertices.resize(nEntries);
+		mesh.ownsEdge.resize(nEntries);
+		mesh.triangles.resize(3 * (nTriangleFaces + 2 * nQuadFaces));
+		mesh.faceOffsets[nf] = (uint32_t)nEntries;
+	}
+
+	//writes face f with its first vertex entry and its first triangle, the meshes of the generators are closed
+	//and consistently oriented, so every edge is owned by the face in which it runs to the larger index
+	//v is in the order passed to add_face, which makes the halfedge from the last to the first vertex the halfedge of
+	//the face, so the face is stored starting at its last vertex like in FlatMesh(const HEMesh&)
+	template <int N>
+	void WriteFlatFace(FlatMesh& mesh, size_t f, size_t entry, size_t triangle, const int (&v)[N])
+	{
+		int rotated[N];
+		for (int i = 0; i < N; ++i)
+			rotated[i] = v[(i + N - 1) % N];
+
+		mesh.faceOffsets[f] = (uint32_t)entry;
+		for (int i = 0; i < N; ++i)
+		{
+			mesh.faceVertices[entry + i] = (uint32_t)rotated[i];
+			mesh.ownsEdge[entry + i] = rotated[i] < rotated[(i + 1) % N];
+		}
+		for (int i = 1; i + 1 < N; ++i)
+		{
+			mesh.triangles[3 * (triangle + i - 1) + 0] = (uint32_t)rotated[0];
+			mesh.triangles[3 * (triangle + i - 1) + 1] = (uint32_t)rotated[i];
+			mesh.triangles[3 * (triangle + i - 1) + 2] = (uint32_t)rotated[i + 1];
+		}
+	}
+
+	void WriteFlatVertex(FlatMesh& mesh, size_t v, const OpenMesh::Vec3f& p)
+	{
+		mesh.x[v] = p[0];
+		mesh.y[v] = p[1];
+		mesh.z[v] = p[2];
+	}
+}
+
+void CreateCylinder(FlatMesh& mesh, float radius, float height, int stacks, int slices, nse::util::ThreadPool* pool)
+{
+	assert(slices >= 3 && stacks >= 1);
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	int n = 2 + slices*(stacks + 1);
+	AllocateFlatMesh(mesh, n, 2 * slices, slices*stacks);
+
+	WriteFlatVertex(mesh, 0, OpenMesh::Vec3f(0.0f, height, 0.0f));
+	pool->ParallelFor(stacks + 1, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (int i = (int)begin; i < (int)end; i++)
+		{
+			float h = (stacks - i)*height / (stacks);
+
+			for (int j = 0; j < slices; j++)
+			{
+				float angle2 = j*2.0f*3.14159f / (float)(slices);
+				WriteFlatVertex(mesh, 1 + i*slices + j, OpenMesh::Vec3f(cos(angle2)*radius, h, sin(angle2)*radius));
+			}
+		}
+	});
+	WriteFlatVertex(mesh, n - 1, OpenMesh::Vec3f(0.0f, 0.0f, 0.0f));
+
+	//per slice: the top cap triangle, one quad per stack and the bottom cap triangle
+	pool->ParallelFor(slices, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (int i = (int)begin; i < (int)end; i++)
+		{
+			size_t f = (size_t)i*(stacks + 2);
+			size_t entry = (size_t)i*(6 + 4 * stacks);
+			size_t triangle = (size_t)i*(2 + 2 * stacks);
+
+			WriteFlatFace(mesh, f++, entry, triangle, { 0, 1 + (1 + i) % slices, 1 + i%slices });
+			entry += 3; triangle += 1;
+
+			for (int j = 0; j < stacks; j++)
+			{
+				int a, b, c, d;
+				a = 1 + j*slices + (i) % slices;
+				b = 1 + j*slices + (1 + i) % slices;
+				c = 1 + (j + 1)*slices + (1 + i) % slices;
+				d = 1 + (j + 1)*slices + (i) % slices;
+				WriteFlatFace(mesh, f++, entry, triangle, { a, b, c, d });
+				entry += 4; triangle += 2;
+			}
+			WriteFlatFace(mesh, f, entry, triangle, { n - 1,
+				1 + (stacks)*slices + (i) % slices,
+				1 + (stacks)*slices + (1 + i) % slices });
+		}
+	});
+}
+
+void CreateSphere(FlatMesh& mesh, float radius, int slices, int stacks, nse::util::ThreadPool* pool)
+{
+	assert(slices >= 3 && stacks >= 3);
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	int n = slices*(stacks - 1) + 2;
+	AllocateFlatMesh(mesh, n, 2 * slices, slices*(stacks - 2));
+
+	WriteFlatVertex(mesh, 0, OpenMesh::Vec3f(0.0f, radius, 0.0f));
+	pool->ParallelFor(stacks - 1, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (int i = 1 + (int)begin; i < 1 + (int)end; i++)
+		{
+			float angle1 = 3.14159f / 2.0f - i*3.14159f / (float)stacks;
+			float r = cos(angle1)*radius;
+			float height = sin(angle1)*radius;
+
+			for (int j = 0; j < slices; j++)
+			{
+				float angle2 = j*2.0f*3.14159f / (float)(slices);
+				WriteFlatVertex(mesh, 1 + (i - 1)*slices + j, OpenMesh::Vec3f(cos(angle2)*r, height, sin(angle2)*r));
+			}
+		}
+	});
+	WriteFlatVertex(mesh, n - 1, OpenMesh::Vec3f(0.0f, -radius, 0.0f));
+
+	//per slice: the top cap triangle, one quad per inner stack and the bottom cap triangle
+	pool->ParallelFor(slices, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (int i = (int)begin; i < (int)end; i++)
+		{
+			size_t f = (size_t)i*stacks;
+			size_t entry = (size_t)i*(6 + 4 * (stacks - 2));
+			size_t triangle = (size_t)i*(2 + 2 * (stacks - 2));
+
+			WriteFlatFace(mesh, f++, entry, triangle, { 0, 1 + (1 + i) % slices, 1 + i%slices });
+			entry += 3; triangle += 1;
+
+			for (int j = 0; j < stacks - 2; j++)
+			{
+				int a, b, c, d;
+				a = 1 + j*slices + (i) % slices;
+				b = 1 + j*slices + (1 + i) % slices;
+				c = 1 + (j + 1)*slices + (1 + i) % slices;
+				d = 1 + (j + 1)*slices + (i) % slices;
+				WriteFlatFace(mesh, f++, entry, triangle, { a, b, c, d });
+				entry += 4; triangle += 2;
+			}
+			WriteFlatFace(mesh, f, entry, triangle, { 1 + slices*(stacks - 1),
+				1 + (stacks - 2)*slices + (i) % slices,
+				1 + (stacks - 2)*slices + (1 + i) % slices });
+		}
+	});
+}
+
+void CreateTorus(FlatMesh& mesh, float r, float R, int nsides, int rings, nse::util::ThreadPool* pool)
+{
+	assert(nsides >= 3 && rings >= 3);
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	int n = rings*nsides;
+	AllocateFlatMesh(mesh, n, 0, (size_t)rings*nsides);
+
+	pool->ParallelFor(rings, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (int i = (int)begin; i < (int)end; i++)
+		{
+			float angle1 = (float)(i*2.0*3.14159 / (rings));
+			OpenMesh::Vec3f center(cos(angle1)*R, 0.0f, sin(angle1)*R);
+			OpenMesh::Vec3f t1(cos(angle1), 0.0, sin(angle1));
+			OpenMesh::Vec3f t2(0.0f, 1.0f, 0.0f);
+
+			for (int j = 0; j < nsides; j++)
+			{
+				float angle2 = (float)(j*2.0*3.14159 / (nsides));
+				WriteFlatVertex(mesh, i*nsides + j, center + (float)(sin(angle2)*r)*t1 + (float)(cos(angle2)*r)*t2);
+			}
+
+			for (int j = 0; j < nsides; j++)
+			{
+				int a, b, c, d;
+				a = (i + 1) % (rings)*(nsides)+j;
+				b = (i + 1) % (rings)*(nsides)+(j + 1) % (nsides);
+				c = i*(nsides)+(j + 1) % (nsides);
+				d = i*(nsides)+j;
+				size_t f = (size_t)i*nsides + j;
+				WriteFlatFace(mesh, f, 4 * f, 2 * f, { a, b, c, d });
+			}
+		}
+	});
+}
+
+void ToHEMesh(const FlatMesh& flat, HEMesh& mesh)
+{
+	mesh.clear();
+	//every edge has exactly one owner
+	size_t nEdges = 0;
+	for (auto owns : flat.ownsEdge)
+		nEdges += owns;
+	mesh.reserve(flat.NumVertices(), nEdges, flat.NumFaces());
+
+	for (size_t v = 0; v < flat.NumVertices(); ++v)
+		mesh.add_vertex(OpenMesh::Vec3f(flat.x[v], flat.y[v], flat.z[v]));
+
+	//add_face makes the halfedge from the last to the first vertex the halfedge of the face, starting the list at the
+	//second vertex lets the face start at the same vertex as in the flat mesh
+	std::vector<OpenMesh::VertexHandle> vhandles;
+	for (size_t f = 0; f < flat.NumFaces(); ++f)
+	{
+		vhandles.clear();
+		for (uint32_t i = flat.faceOffsets[f] + 1; i < flat.faceOffsets[f + 1]; ++i)
+			vhandles.push_back(OpenMesh::VertexHandle((int)flat.faceVertices[i]));
+		vhandles.push_back(OpenMesh::VertexHandle((int)flat.faceVertices[flat.faceOffsets[f]]));
+		mesh.add_face(vhandles);
+	}
+}
+
+void BenchmarkPrimitiveGeneration(HEMesh& mesh, int resolution)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	std::cout << std::fixed << "Primitive generation with resolution " << resolution << " on "
+	          << nse::util::ThreadPool::Instance()->NumThreads() << " threads:" << std::endl;
+	for (int primitive = 0; primitive < 3; ++primitive)
+	{
+		const char* names[] = { "sphere", "torus", "cylinder" };
+		FlatMesh flat;
+		auto timeStart = Clock::now();
+		if (primitive == 0)
+			CreateSphere(mesh, 1, resolution, resolution);
+		else if (primitive == 1)
+			CreateTorus(mesh, 0.4f, 1, resolution, resolution);
+		else
+			CreateCylinder(mesh, 0.3f, 1, resolution, resolution);
+		auto directTime = Clock::now() - timeStart;
+
+		timeStart = Clock::now();
+		if (primitive == 0)
+			CreateSphere(flat, 1, resolution, resolution);
+		else if (primitive == 1)
+			CreateTorus(flat, 0.4f, 1, resolution, resolution);
+		else
+			CreateCylinder(flat, 0.3f, 1, resolution, resolution);
+		auto flatTime = Clock::now() - timeStart;
+
+		//the flat generator has to reproduce the halfedge mesh exactly
+		bool identical = flat.NumVertices() == mesh.n_vertices() && flat.NumFaces() == mesh.n_faces();
+		for (auto v : mesh.vertices())
+		{
+			if (!identical)
+				break;
+			auto& p = mesh.point(v);
+			identical = p[0] == flat.x[v.idx()] && p[1] == flat.y[v.idx()] && p[2] == flat.z[v.idx()];
+		}
+		//faces have to start at the same vertex to get the same triangle fans
+		if (identical)
+		{
+			FlatMesh reference(mesh);
+			identical = flat.faceOffsets == reference.faceOffsets && flat.faceVertices == reference.faceVertices
+				&& flat.triangles == reference.triangles;
+		}
+
+		timeStart = Clock::now();
+		ToHEMesh(flat, mesh);
+		auto conversionTime = Clock::now() - timeStart;
+		//the conversion back keeps the faces as they are
+		identical = identical && FlatMesh(mesh).faceVertices == flat.faceVertices;
+
+		std::cout << " - " << names[primitive] << " (" << flat.NumVertices() << " vertices, " << flat.NumFaces() << " faces):" << std::endl
+		          << "     add_vertex/add_face: " << milliseconds(directTime) << "ms" << std::endl
+		          << "     flat arrays:         " << milliseconds(flatTime) << "ms (" << milliseconds(directTime) / std::max(milliseconds(flatTime), 1e-9) << "x)" << std::endl
+		          << "     conversion to HEMesh: " << milliseconds(conversionTime) << "ms" << std::endl
+		          << "     " << (identical ? "identical to" : "DIFFERENT from") << " the halfedge generator" << std::endl;
+	}
+}
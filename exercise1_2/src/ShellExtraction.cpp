@@ -4,7 +4,11 @@
 
 #include <map>
 #include <queue>
+#include <atomic>
+#include <limits>
+#include <algorithm>
 #include "util/UnionFind.h"
+#include "util/ConcurrentUnionFind.h"
 #include "ShellExtraction.h"
 
 
@@ -42,3 +46,144 @@ unsigned int ExtractShells(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIn
     }
     return shellIndex;
 }
+
+namespace
+{
+    // atomically replaces target by value if value is smaller (or larger, for Max)
+    void AtomicMin(std::atomic<float>& target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+    void AtomicMax(std::atomic<float>& target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+}
+
+unsigned int ExtractShellsParallel(HEMesh& m, OpenMesh::FPropHandleT<int> perFaceShellIndex,
+                                   std::vector<ShellInfo>* shells, nse::util::ThreadPool* pool)
+{
+    if (pool == nullptr)
+        pool = nse::util::ThreadPool::Instance();
+    size_t numFaces = m.n_faces();
+    nse::util::ConcurrentUnionFind unionFind(numFaces, pool);
+
+    // Step 1: merge the two faces of every interior edge
+    pool->ParallelForChunks(m.n_edges(), 4096, [&](size_t begin, size_t end)
+    {
+        for (size_t e = begin; e < end; ++e)
+        {
+            OpenMesh::EdgeHandle eh((int)e);
+            auto f0 = m.face_handle(m.halfedge_handle(eh, 0));
+            auto f1 = m.face_handle(m.halfedge_handle(eh, 1));
+            if (f0.is_valid() && f1.is_valid())
+                unionFind.Merge(f0.idx(), f1.idx());
+        }
+    });
+
+    // Step 2: the roots are the first faces of their shells, number them in face order with a prefix sum over the parts
+    std::vector<uint32_t> roots(numFaces);
+    std::vector<uint32_t> partRootCounts(pool->NumThreads() + 1, 0);
+    pool->ParallelFor(numFaces, [&](size_t begin, size_t end, unsigned int part)
+    {
+        uint32_t count = 0;
+        for (size_t f = begin; f < end; ++f)
+        {
+            roots[f] = unionFind.GetRepresentative((uint32_t)f);
+            count += roots[f] == f;
+        }
+        partRootCounts[part + 1] = count;
+    });
+    for (size_t part = 1; part < partRootCounts.size(); ++part)
+        partRootCounts[part] += partRootCounts[part - 1];
+    unsigned int numShells = partRootCounts.back();
+
+    std::vector<int> shellOfRoot(numFaces);
+    pool->ParallelFor(numFaces, [&](size_t begin, size_t end, unsigned int part)
+    {
+        uint32_t next = partRootCounts[part];
+        for (size_t f = begin; f < end; ++f)
+            if (roots[f] == f)
+                shellOfRoot[f] = (int)next++;
+    });
+
+    // Step 3: label all faces and accumulate the shell infos, consecutive faces of the same shell are
+    // accumulated locally to keep the atomic updates rare
+    std::vector<std::atomic<unsigned int>> faceCounts(shells != nullptr ? numShells : 0);
+    std::vector<std::atomic<float>> lower(shells != nullptr ? 3 * numShells : 0), upper(lower.size());
+    for (size_t i = 0; i < faceCounts.size(); ++i)
+        faceCounts[i].store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < lower.size(); ++i)
+    {
+        lower[i].store(std::numeric_limits<float>::max(), std::memory_order_relaxed);
+        upper[i].store(std::numeric_limits<float>::lowest(), std::memory_order_relaxed);
+    }
+
+    pool->ParallelFor(numFaces, [&](size_t begin, size_t end, unsigned int)
+    {
+        int runShell = -1;
+        unsigned int runFaces = 0;
+        float runLower[3], runUpper[3];
+        auto flush = [&]()
+        {
+            if (runShell < 0)
+                return;
+            faceCounts[runShell].fetch_add(runFaces, std::memory_order_relaxed);
+            for (int d = 0; d < 3; ++d)
+            {
+                AtomicMin(lower[3 * runShell + d], runLower[d]);
+                AtomicMax(upper[3 * runShell + d], runUpper[d]);
+            }
+        };
+
+        for (size_t f = begin; f < end; ++f)
+        {
+            OpenMesh::FaceHandle fh((int)f);
+            int shell = shellOfRoot[roots[f]];
+            m.property(perFaceShellIndex, fh) = shell;
+            if (shells == nullptr)
+                continue;
+
+            if (shell != runShell)
+            {
+                flush();
+                runShell = shell;
+                runFaces = 0;
+                std::fill(runLower, runLower + 3, std::numeric_limits<float>::max());
+                std::fill(runUpper, runUpper + 3, std::numeric_limits<float>::lowest());
+            }
+            ++runFaces;
+            for (auto v : m.fv_range(fh))
+            {
+                auto& p = m.point(v);
+                for (int d = 0; d < 3; ++d)
+                {
+                    runLower[d] = std::min(runLower[d], p[d]);
+                    runUpper[d] = std::max(runUpper[d], p[d]);
+                }
+            }
+        }
+        flush();
+    });
+
+    if (shells != nullptr)
+    {
+        shells->assign(numShells, ShellInfo());
+        for (unsigned int s = 0; s < numShells; ++s)
+        {
+            ShellInfo& info = (*shells)[s];
+            info.numFaces = faceCounts[s].load(std::memory_order_relaxed);
+            Eigen::Matrix<float, 3, 2> corners;
+            for (int d = 0; d < 3; ++d)
+            {
+                corners(d, 0) = lower[3 * s + d].load(std::memory_order_relaxed);
+                corners(d, 1) = upper[3 * s + d].load(std::memory_order_relaxed);
+            }
+            info.bbox.expand(corners);
+        }
+    }
+    return numShells;
+}
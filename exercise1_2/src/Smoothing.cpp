@@ -4,7 +4,15 @@
 
 #include <memory>
 #include <random>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include <cstring>
 #include "Smoothing.h"
+#include "MeshLaplacian.h"
 
 
 void SmoothUniformLaplacian(HEMesh& m, float lambda)
@@ -38,7 +46,7 @@ void SmoothUniformLaplacian(HEMesh& m, float lambda)
     }
 }
 
-float cotangent(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2)
+float cotangent(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const OpenMesh::Vec3f& p2, SmoothingIssueCounts& issues)
 {
     OpenMesh::Vec3f v1 = p1 - p0;
     OpenMesh::Vec3f v2 = p2 - p0;
@@ -46,7 +54,7 @@ float cotangent(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const Open
     float sin_angle = OpenMesh::cross(v1, v2).norm();
 
     if (sin_angle < 1e-6f) { // Prevent division by zero or very small values
-        std::cerr << "Warning: Very small sin_angle, clamping to 1e-6\n";
+        issues.Count(SmoothingIssue::SmallSine);
         sin_angle = 1e-6f;
     }
 
@@ -54,17 +62,55 @@ float cotangent(const OpenMesh::Vec3f& p0, const OpenMesh::Vec3f& p1, const Open
 
     // Clamp cotangent to avoid extreme values
     if (std::abs(cot) > 1e6f) {
-        std::cerr << "Warning: Extreme cotangent value, clamping to 1e6\n";
+        issues.Count(SmoothingIssue::ExtremeCotangent);
         cot = (cot > 0) ? 1e6f : -1e6f;
     }
 
     return cot;
 }
 
-void SmoothCotanLaplacian(HEMesh& m, float lambda)
+void SmoothCotanLaplacian(HEMesh& m, float lambda, SmoothingDiagnostics* diagnostics)
 {
     std::vector<OpenMesh::Vec3f> new_positions(m.n_vertices());
+    SmoothingIssueCounts issues;
+
+    // Step 1: Compute the cotangent weight of every edge once, NaN marks edges that are skipped
+    std::vector<float> edge_weights(m.n_edges());
+    for (auto eh : m.edges()) {
+        auto he0 = m.halfedge_handle(eh, 0);
+        auto he1 = m.halfedge_handle(eh, 1);
+        // boundary edges are only incident to boundary vertices, which are not moved
+        if (m.is_boundary(he0) || m.is_boundary(he1)) {
+            edge_weights[eh.idx()] = std::nanf("");
+            continue;
+        }
+
+        // vertices opposite to the edge in the two adjacent triangles
+        auto p0 = m.point(m.from_vertex_handle(he0));
+        auto p1 = m.point(m.to_vertex_handle(he0));
+        auto p2 = m.point(m.to_vertex_handle(m.next_halfedge_handle(he0)));
+        auto p3 = m.point(m.to_vertex_handle(m.next_halfedge_handle(he1)));
+
+        // cotangents of the angles at the opposite vertices
+        float cot_alpha = cotangent(p2, p0, p1, issues);
+        float cot_beta = cotangent(p3, p0, p1, issues);
+
+        if (std::isnan(cot_alpha) || std::isnan(cot_beta)) {
+            issues.Count(SmoothingIssue::InvalidCotangent);
+            edge_weights[eh.idx()] = std::nanf("");
+            continue;
+        }
 
+        float weight = cot_alpha + cot_beta;
+
+        if (std::isnan(weight) || std::isinf(weight)) {
+            issues.Count(SmoothingIssue::InvalidWeight);
+            weight = std::nanf("");
+        }
+        edge_weights[eh.idx()] = weight;
+    }
+
+    // Step 2: Move every interior vertex along its weighted Laplacian
     for (auto vh : m.vertices()) {
         if (m.is_boundary(vh)) {
             new_positions[vh.idx()] = m.point(vh);
@@ -73,46 +119,27 @@ void SmoothCotanLaplacian(HEMesh& m, float lambda)
 
         OpenMesh::Vec3f laplacian(0.0f, 0.0f, 0.0f);
         float area_sum = 0.0f;
+        auto p0 = m.point(vh);
 
         for (auto he : m.voh_range(vh)) {
-            auto neighbor = m.to_vertex_handle(he);
-
-            auto he_next = m.next_halfedge_handle(he);
-            auto he_prev = m.opposite_halfedge_handle(m.next_halfedge_handle(m.opposite_halfedge_handle(he)));
-
-            auto p0 = m.point(vh);
-            auto p1 = m.point(neighbor);
-            auto p2 = m.point(m.to_vertex_handle(he_next));
-            auto p3 = m.point(m.to_vertex_handle(he_prev));
-
-            float cot_alpha = cotangent(p0, p2, p1);
-            float cot_beta = cotangent(p0, p3, p1);
-
-            if (std::isnan(cot_alpha) || std::isnan(cot_beta)) {
-                std::cerr << "Warning: Invalid cotangent value for vertex " << vh.idx() << "\n";
+            float weight = edge_weights[m.edge_handle(he).idx()];
+            if (std::isnan(weight))
                 continue;
-            }
-
-            float weight = cot_alpha + cot_beta;
-
-            if (std::isnan(weight) || std::isinf(weight)) {
-                std::cerr << "Warning: Invalid weight for edge (" << vh.idx() << ", " << neighbor.idx() << ")\n";
-                continue;
-            }
 
+            auto p1 = m.point(m.to_vertex_handle(he));
             laplacian += weight * (p1 - p0);
             area_sum += weight;
         }
 
         if (area_sum < 1e-6f) {
-            std::cerr << "Warning: Very small area_sum for vertex " << vh.idx() << ", clamping to 1e-6\n";
+            issues.Count(SmoothingIssue::SmallWeightSum);
             area_sum = 1e-6f;
         }
 
         laplacian /= (2.0f * area_sum);
 
         if (std::isnan(laplacian[0]) || std::isnan(laplacian[1]) || std::isnan(laplacian[2])) {
-            std::cerr << "Warning: Invalid Laplacian for vertex " << vh.idx() << ", resetting to zero\n";
+            issues.Count(SmoothingIssue::InvalidLaplacian);
             laplacian = OpenMesh::Vec3f(0.0f, 0.0f, 0.0f);
         }
 
@@ -121,7 +148,7 @@ void SmoothCotanLaplacian(HEMesh& m, float lambda)
         // Check new position validity
         auto& new_pos = new_positions[vh.idx()];
         if (std::isnan(new_pos[0]) || std::isnan(new_pos[1]) || std::isnan(new_pos[2])) {
-            std::cerr << "Warning: Invalid new position for vertex " << vh.idx() << ", resetting to original\n";
+            issues.Count(SmoothingIssue::InvalidPosition);
             new_positions[vh.idx()] = m.point(vh);
         }
     }
@@ -129,28 +156,213 @@ void SmoothCotanLaplacian(HEMesh& m, float lambda)
     for (auto vh : m.vertices()) {
         m.set_point(vh, new_positions[vh.idx()]);
     }
+
+    // report the numerical problems once instead of per occurrence
+    if (diagnostics != nullptr)
+        diagnostics->Add(issues);
+    else
+    {
+        SmoothingDiagnostics callDiagnostics;
+        callDiagnostics.Add(issues);
+        callDiagnostics.Report(std::cerr, "Cotangent Laplacian smoothing");
+    }
+}
+
+void SmoothUniformLaplacian(HEMesh& m, float lambda, unsigned int iterations)
+{
+    MeshLaplacian laplacian(m);
+    for (unsigned int i = 0; i < iterations; ++i)
+        laplacian.SmoothUniform(lambda);
+    laplacian.StorePositions(m);
 }
 
+void SmoothCotanLaplacian(HEMesh& m, float lambda, unsigned int iterations, unsigned int weightUpdateInterval)
+{
+    MeshLaplacian laplacian(m);
+    laplacian.SetWeightUpdateInterval(weightUpdateInterval);
+    for (unsigned int i = 0; i < iterations; ++i)
+        laplacian.SmoothCotan(lambda);
+    laplacian.StorePositions(m);
+    laplacian.Diagnostics().Report(std::cerr, "Cotangent Laplacian smoothing");
+}
+
+void BenchmarkSmoothing(const HEMesh& m, float lambda, unsigned int iterations)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::cout << std::fixed << "Smoothing benchmark with " << iterations << " iterations on "
+              << m.n_vertices() << " vertices in " << m.n_faces() << " faces:" << std::endl;
+
+    for (int cotan = 0; cotan < 2; ++cotan)
+    {
+        // reference: one circulator pass per iteration
+        HEMesh reference = m;
+        SmoothingDiagnostics diagnostics;
+        auto timeStart = Clock::now();
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            if (cotan)
+                SmoothCotanLaplacian(reference, lambda, &diagnostics);
+            else
+                SmoothUniformLaplacian(reference, lambda);
+        }
+        auto circulatorTime = Clock::now() - timeStart;
+
+        // compiled snapshot, timed separately for compilation, iterations and write-back
+        HEMesh result = m;
+        timeStart = Clock::now();
+        MeshLaplacian laplacian(result);
+        auto compileTime = Clock::now() - timeStart;
+        timeStart = Clock::now();
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            if (cotan)
+                laplacian.SmoothCotan(lambda);
+            else
+                laplacian.SmoothUniform(lambda);
+        }
+        auto iterationTime = Clock::now() - timeStart;
+        timeStart = Clock::now();
+        laplacian.StorePositions(result);
+        auto storeTime = Clock::now() - timeStart;
+
+        float maxDeviation = 0.0f;
+        for (auto v : m.vertices())
+            maxDeviation = std::max(maxDeviation, (reference.point(v) - result.point(v)).norm());
+
+        auto snapshotTime = compileTime + iterationTime + storeTime;
+        std::cout << (cotan ? " - cotangent Laplacian:" : " - uniform Laplacian:") << std::endl
+                  << "     circulators: " << milliseconds(circulatorTime) << "ms" << std::endl
+                  << "     snapshot:    " << milliseconds(snapshotTime) << "ms (compile " << milliseconds(compileTime)
+                  << "ms, iterations " << milliseconds(iterationTime) << "ms, write-back " << milliseconds(storeTime) << "ms)" << std::endl
+                  << "     speedup:     " << milliseconds(circulatorTime) / std::max(milliseconds(snapshotTime), 1e-9) << "x" << std::endl
+                  << "     max. deviation: " << maxDeviation << std::endl;
+    }
+
+    // frozen cotangent weights trade accuracy for speed, compared against weights updated in every iteration
+    std::vector<OpenMesh::Vec3f> exactResult;
+    for (unsigned int interval : { 1u, 2u, 5u, 10u })
+    {
+        MeshLaplacian laplacian(m);
+        laplacian.SetWeightUpdateInterval(interval);
+        auto timeStart = Clock::now();
+        for (unsigned int i = 0; i < iterations; ++i)
+            laplacian.SmoothCotan(lambda);
+        auto time = Clock::now() - timeStart;
+
+        float maxDeviation = 0.0f;
+        if (interval == 1)
+        {
+            exactResult.resize(laplacian.NumVertices());
+            for (size_t v = 0; v < exactResult.size(); ++v)
+                exactResult[v] = laplacian.Position(v);
+        }
+        for (size_t v = 0; v < exactResult.size(); ++v)
+            maxDeviation = std::max(maxDeviation, (laplacian.Position(v) - exactResult[v]).norm());
+        std::cout << " - cotangent weights updated every " << std::setw(2) << interval << " iterations: "
+                  << milliseconds(time) << "ms, max. deviation " << maxDeviation << std::endl;
+    }
+}
+
+void BenchmarkSmoothingScaling(const HEMesh& m, float lambda, unsigned int iterations)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::cout << std::fixed << "Smoothing scaling with " << iterations << " iterations on "
+              << m.n_vertices() << " vertices (" << std::thread::hardware_concurrency() << " hardware threads):" << std::endl;
+
+    for (int cotan = 0; cotan < 2; ++cotan)
+    {
+        std::cout << (cotan ? " - cotangent Laplacian:" : " - uniform Laplacian:") << std::endl;
+        std::vector<OpenMesh::Vec3f> serialResult;
+        double serialTime = 0;
+        for (unsigned int threads = 1; threads <= 32; threads *= 2)
+        {
+            nse::util::ThreadPool pool(threads);
+            MeshLaplacian laplacian(m, &pool);
+            auto timeStart = Clock::now();
+            for (unsigned int i = 0; i < iterations; ++i)
+            {
+                if (cotan)
+                    laplacian.SmoothCotan(lambda);
+                else
+                    laplacian.SmoothUniform(lambda);
+            }
+            double time = milliseconds(Clock::now() - timeStart);
+
+            // the result has to be bit-identical to the single-threaded one
+            std::vector<OpenMesh::Vec3f> result(laplacian.NumVertices());
+            for (size_t v = 0; v < result.size(); ++v)
+                result[v] = laplacian.Position(v);
+            if (threads == 1)
+            {
+                serialResult = result;
+                serialTime = time;
+            }
+            bool identical = std::memcmp(result.data(), serialResult.data(), result.size() * sizeof(OpenMesh::Vec3f)) == 0;
+
+            std::cout << "     " << std::setw(2) << threads << " threads: " << time << "ms, speedup "
+                      << serialTime / std::max(time, 1e-9) << "x" << (identical ? "" : ", RESULT DIFFERS FROM SERIAL") << std::endl;
+        }
+    }
+}
+
+void BenchmarkDegenerateSmoothing(const HEMesh& m, float lambda, unsigned int iterations)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    // collapse every third vertex onto one of its neighbors, which creates many zero-area triangles
+    HEMesh degenerate = m;
+    for (auto v : m.vertices())
+    {
+        if (v.idx() % 3 != 0)
+            continue;
+        for (auto vn : m.vv_range(v))
+        {
+            degenerate.set_point(v, m.point(vn));
+            break;
+        }
+    }
+
+    SmoothingDiagnostics diagnostics;
+    auto timeStart = Clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+        SmoothCotanLaplacian(degenerate, lambda, &diagnostics);
+    double smoothingTime = milliseconds(Clock::now() - timeStart);
+
+    // replay the per-occurrence warnings which were written before the problems were counted, through std::cerr
+    // with its unit buffering, but redirected to the null device such that the console is not flooded
+#ifdef _WIN32
+    std::ofstream nullDevice("NUL");
+#else
+    std::ofstream nullDevice("/dev/null");
+#endif
+    double loggingTime = 0.0;
+    if (nullDevice)
+    {
+        std::streambuf* console = std::cerr.rdbuf(nullDevice.rdbuf());
+        timeStart = Clock::now();
+        for (size_t i = 0; i < diagnostics.Total(); ++i)
+            std::cerr << "Warning: Very small sin_angle, clamping to 1e-6\n";
+        loggingTime = milliseconds(Clock::now() - timeStart);
+        std::cerr.rdbuf(console);
+    }
+
+    std::cout << std::fixed << "Cotangent smoothing with " << iterations << " iterations on a degenerate copy of the mesh ("
+              << m.n_vertices() / 3 << " collapsed vertices):" << std::endl
+              << " - counted diagnostics: " << smoothingTime << "ms" << std::endl;
+    if (nullDevice)
+        std::cout << " - per-occurrence logging of " << diagnostics.Total() << " warnings to the null device: " << loggingTime << "ms more" << std::endl;
+    else
+        std::cout << " - per-occurrence logging not measured, the null device cannot be opened" << std::endl;
+    diagnostics.Report(std::cout, "The degenerate smoothing");
+}
 
 void AddNoise (HEMesh &m, OpenMesh::MPropHandleT<Viewer::BBoxType> bbox_prop)
 {
-	std::mt19937 rnd;
-	std::normal_distribution<float> dist;
-
-	for (auto v : m.vertices())
-	{
-		OpenMesh::Vec3f n;
-		m.calc_vertex_normal_correct(v, n);
-		const auto diag = m.property(bbox_prop).diagonal();
-		const float base_diag = std::min(diag.x(), std::min(diag.y(), diag.z())) / 20.f;
-		float base_nb=0, nb_num=0;
-		for (auto vnb : m.vv_range(v))
-		{
-			base_nb += (m.point(v) - m.point(vnb)).norm();
-			nb_num++;
-		}
-		base_nb /= 4.f * nb_num;
-
-		m.point(v) += std::min(base_diag, base_nb) * dist(rnd) * n.normalized();
-	}
+	const Viewer::BBoxType& bbox = m.property(bbox_prop);
+	AddNoise(m, Eigen::AlignedBox3f(bbox.min, bbox.max));
 }
@@ -0,0 +1,59 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "SmoothingDiagnostics.h"
+
+SmoothingDiagnostics::SmoothingDiagnostics()
+{
+	Reset();
+}
+
+void SmoothingDiagnostics::Add(const SmoothingIssueCounts& local)
+{
+	for (int i = 0; i < (int)SmoothingIssue::NumIssues; ++i)
+		if (local.counts[i] != 0)
+			counts[i].fetch_add(local.counts[i], std::memory_order_relaxed);
+}
+
+void SmoothingDiagnostics::Reset()
+{
+	for (auto& c : counts)
+		c.store(0, std::memory_order_relaxed);
+}
+
+size_t SmoothingDiagnostics::Count(SmoothingIssue issue) const
+{
+	return counts[(int)issue].load(std::memory_order_relaxed);
+}
+
+size_t SmoothingDiagnostics::Total() const
+{
+	size_t total = 0;
+	for (auto& c : counts)
+		total += c.load(std::memory_order_relaxed);
+	return total;
+}
+
+void SmoothingDiagnostics::Report(std::ostream& os, const char* operation) const
+{
+	static const char* descriptions[(int)SmoothingIssue::NumIssues] =
+	{
+		"very small sine of an angle, clamped to 1e-6",
+		"extreme cotangent value, clamped to 1e6",
+		"invalid cotangent value, edge skipped",
+		"invalid edge weight, edge skipped",
+		"very small weight sum, clamped to 1e-6",
+		"invalid Laplacian, reset to zero",
+		"invalid new position, reset to original"
+	};
+	if (Total() == 0)
+		return;
+	os << "Warning: " << operation << " encountered numerical problems:" << std::endl;
+	for (int i = 0; i < (int)SmoothingIssue::NumIssues; ++i)
+	{
+		size_t count = counts[i].load(std::memory_order_relaxed);
+		if (count != 0)
+			os << " - " << descriptions[i] << ": " << count << "x" << std::endl;
+	}
+}
@@ -0,0 +1,80 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+/*
+Shell extraction for meshes which are too large for a halfedge mesh.
+
+usage: StreamShells <mesh file (.itri or .obj)> <shell id file> [summary file] [elements per chunk]
+
+Writes the int32 shell index of every face (in file order, OBJ polygons count once per fan triangle) to the shell id
+file. The optional summary file receives one line per shell with its index, number of faces, number of vertices and
+bounding box.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+#include "StreamingShellExtraction.h"
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "usage: " << argv[0] << " <mesh file (.itri or .obj)> <shell id file> [summary file] [elements per chunk]" << std::endl;
+		return 1;
+	}
+	size_t chunkSize = argc > 4 ? std::stoull(argv[4]) : (1 << 20);
+
+	auto timeStart = std::chrono::high_resolution_clock::now();
+	std::vector<StreamingShell> shells;
+	if (!ExtractShellsStreaming(argv[1], argv[2], shells, chunkSize))
+		return 1;
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - timeStart).count();
+
+	uint64_t numFaces = 0;
+	for (auto& shell : shells)
+		numFaces += shell.numFaces;
+	std::cout << "Found " << shells.size() << " shells in " << numFaces << " faces in " << seconds << " s ("
+		<< (seconds > 0 ? numFaces / seconds : 0) << " faces/s)" << std::endl;
+
+	if (argc > 3)
+	{
+		std::ofstream summary(argv[3]);
+		if (!summary)
+		{
+			std::cerr << "Cannot create summary file " << argv[3] << std::endl;
+			return 1;
+		}
+		summary << "# shell faces vertices min_x min_y min_z max_x max_y max_z" << std::endl;
+		for (size_t i = 0; i < shells.size(); ++i)
+		{
+			auto& s = shells[i];
+			summary << i << " " << s.numFaces << " " << s.numVertices << " " << s.lower[0] << " " << s.lower[1] << " " << s.lower[2]
+				<< " " << s.upper[0] << " " << s.upper[1] << " " << s.upper[2] << std::endl;
+		}
+		if (!summary)
+		{
+			std::cerr << "Cannot write summary file " << argv[3] << std::endl;
+			return 1;
+		}
+	}
+
+	//print the largest shells
+	std::vector<size_t> order(shells.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	size_t numListed = std::min<size_t>(order.size(), 10);
+	std::partial_sort(order.begin(), order.begin() + numListed, order.end(),
+		[&](size_t a, size_t b) { return shells[a].numFaces > shells[b].numFaces; });
+	for (size_t i = 0; i < numListed; ++i)
+	{
+		auto& s = shells[order[i]];
+		std::cout << "  shell " << order[i] << ": " << s.numFaces << " faces, " << s.numVertices << " vertices, bounding box ("
+			<< s.lower[0] << ", " << s.lower[1] << ", " << s.lower[2] << ") - (" << s.upper[0] << ", " << s.upper[1] << ", " << s.upper[2] << ")" << std::endl;
+	}
+	return 0;
+}
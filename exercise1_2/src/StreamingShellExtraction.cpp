@@ -0,0 +1,354 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "StreamingShellExtraction.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include <util/UnionFind.h>
+#include <util/IndexedTriangleFile.h>
+
+StreamingShell::StreamingShell()
+{
+	std::fill(lower, lower + 3, std::numeric_limits<float>::max());
+	std::fill(upper, upper + 3, std::numeric_limits<float>::lowest());
+}
+
+namespace
+{
+	//sequential source of vertices and triangles which can be read several times
+	class TriangleSource
+	{
+	public:
+		virtual ~TriangleSource() { }
+
+		//starts a new pass over the input
+		virtual bool Rewind() = 0;
+
+		//reads the next chunk of vertices (appended to xyz, the first one has the index firstVertex) and triangles
+		//returns false if the input is exhausted
+		virtual bool NextChunk(std::vector<float>& xyz, uint64_t& firstVertex, std::vector<uint32_t>& triangles) = 0;
+
+		//returns if the input could not be read or parsed
+		virtual bool Failed() const = 0;
+	};
+
+	class IndexedTriangleSource : public TriangleSource
+	{
+	public:
+		IndexedTriangleSource(size_t chunkSize)
+			: chunkSize(chunkSize), failed(false), nextVertex(0), nextTriangle(0), readingTriangles(false)
+		{ }
+
+		bool Open(const std::string& path)
+		{
+			this->path = path;
+			return reader.Open(path.c_str());
+		}
+
+		bool Rewind() override
+		{
+			nextVertex = 0;
+			nextTriangle = 0;
+			readingTriangles = false;
+			return reader.SeekVertices();
+		}
+
+		bool NextChunk(std::vector<float>& xyz, uint64_t& firstVertex, std::vector<uint32_t>& triangles) override
+		{
+			xyz.clear();
+			triangles.clear();
+			firstVertex = nextVertex;
+			if (!readingTriangles)
+			{
+				xyz.resize(3 * chunkSize);
+				size_t count = reader.ReadVertices(xyz.data(), chunkSize);
+				xyz.resize(3 * count);
+				nextVertex += count;
+				if (count > 0)
+					return true;
+				if (nextVertex != reader.NumVertices() || !reader.SeekTriangles())
+					return Fail("vertices");
+				readingTriangles = true;
+			}
+			triangles.resize(3 * chunkSize);
+			size_t count = reader.ReadTriangles(triangles.data(), chunkSize);
+			triangles.resize(3 * count);
+			nextTriangle += count;
+			if (count > 0)
+				return true;
+			//the file ended before all triangles of the header were read
+			if (nextTriangle != reader.NumTriangles())
+				return Fail("triangles");
+			return false;
+		}
+
+		bool Failed() const override { return failed; }
+
+	private:
+		bool Fail(const char* section)
+		{
+			std::cerr << "Cannot read all " << section << " of " << path << ", the file is truncated or damaged" << std::endl;
+			failed = true;
+			return false;
+		}
+
+		nse::util::IndexedTriangleReader reader;
+		std::string path;
+		size_t chunkSize;
+		bool failed;
+		uint64_t nextVertex;
+		uint64_t nextTriangle;
+		bool readingTriangles;
+	};
+
+	//reads the v and f lines of an OBJ file, everything else is ignored
+	class OBJSource : public TriangleSource
+	{
+	public:
+		OBJSource(size_t chunkSize)
+			: chunkSize(chunkSize), failed(false), numVertices(0)
+		{ }
+
+		bool Open(const std::string& path)
+		{
+			this->path = path;
+			file.open(path);
+			return file.good();
+		}
+
+		bool Rewind() override
+		{
+			file.clear();
+			file.seekg(0);
+			numVertices = 0;
+			return file.good();
+		}
+
+		bool NextChunk(std::vector<float>& xyz, uint64_t& firstVertex, std::vector<uint32_t>& triangles) override
+		{
+			xyz.clear();
+			triangles.clear();
+			firstVertex = numVertices;
+			while (xyz.size() / 3 + triangles.size() / 3 < chunkSize && std::getline(file, line))
+			{
+				const char* c = line.c_str();
+				while (*c == ' ' || *c == '\t')
+					++c;
+				if (c[0] == 'v' && (c[1] == ' ' || c[1] == '\t'))
+				{
+					char* end;
+					c += 2;
+					for (int d = 0; d < 3; ++d)
+					{
+						xyz.push_back(std::strtof(c, &end));
+						if (end == c)
+							return Fail("invalid vertex");
+						c = end;
+					}
+					++numVertices;
+				}
+				else if (c[0] == 'f' && (c[1] == ' ' || c[1] == '\t'))
+				{
+					polygon.clear();
+					c += 2;
+					while (true)
+					{
+						char* end;
+						long index = std::strtol(c, &end, 10);
+						if (end == c)
+							break;
+						//relative indices count backwards from the last vertex
+						long long absolute = index < 0 ? (long long)numVertices + index : (long long)index - 1;
+						if (index == 0 || absolute < 0 || absolute > std::numeric_limits<uint32_t>::max())
+							return Fail("invalid face index");
+						polygon.push_back((uint32_t)absolute);
+						//skip texture coordinate and normal indices
+						c = end;
+						while (*c != 0 && *c != ' ' && *c != '\t')
+							++c;
+					}
+					for (size_t i = 1; i + 1 < polygon.size(); ++i)
+					{
+						triangles.push_back(polygon[0]);
+						triangles.push_back(polygon[i]);
+						triangles.push_back(polygon[i + 1]);
+					}
+				}
+			}
+			if (file.bad())
+				return Fail("read error");
+			return !xyz.empty() || !triangles.empty();
+		}
+
+		bool Failed() const override { return failed; }
+
+	private:
+		bool Fail(const char* reason)
+		{
+			std::cerr << "Cannot parse " << path << ": " << reason << " in line \"" << line << "\"" << std::endl;
+			failed = true;
+			return false;
+		}
+
+		std::ifstream file;
+		std::string path;
+		std::string line;
+		std::vector<uint32_t> polygon;
+		size_t chunkSize;
+		bool failed;
+		uint64_t numVertices;
+	};
+
+	bool HasExtension(const std::string& path, const std::string& extension)
+	{
+		if (path.size() < extension.size())
+			return false;
+		std::string suffix = path.substr(path.size() - extension.size());
+		std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](char c) { return (char)std::tolower(c); });
+		return suffix == extension;
+	}
+}
+
+bool ExtractShellsStreaming(const std::string& inputPath, const std::string& shellIdPath, std::vector<StreamingShell>& shells, size_t chunkSize)
+{
+	shells.clear();
+	chunkSize = std::max<size_t>(1, chunkSize);
+
+	std::unique_ptr<TriangleSource> source;
+	if (HasExtension(inputPath, ".obj"))
+	{
+		auto obj = new OBJSource(chunkSize);
+		source.reset(obj);
+		if (!obj->Open(inputPath))
+		{
+			std::cerr << "Cannot open " << inputPath << std::endl;
+			return false;
+		}
+	}
+	else
+	{
+		auto indexed = new IndexedTriangleSource(chunkSize);
+		source.reset(indexed);
+		if (!indexed->Open(inputPath))
+		{
+			std::cerr << "Cannot open " << inputPath << " as indexed triangle file" << std::endl;
+			return false;
+		}
+	}
+
+	std::vector<float> xyz;
+	std::vector<uint32_t> triangles;
+	uint64_t firstVertex;
+
+	//first pass: merge the vertices of every triangle
+	nse::util::UnionFind unionFind;
+	std::vector<bool> used;
+	std::vector<std::pair<nse::util::UnionFind::index_t, nse::util::UnionFind::index_t>> pairs;
+	if (!source->Rewind())
+	{
+		std::cerr << "Cannot read " << inputPath << std::endl;
+		return false;
+	}
+	while (source->NextChunk(xyz, firstVertex, triangles))
+	{
+		size_t numVertices = (size_t)firstVertex + xyz.size() / 3;
+		if (numVertices > unionFind.size())
+		{
+			if (numVertices > std::numeric_limits<nse::util::UnionFind::index_t>::max())
+			{
+				std::cerr << inputPath << " has too many vertices" << std::endl;
+				return false;
+			}
+			unionFind.AddItems(numVertices - unionFind.size());
+			used.resize(numVertices, false);
+		}
+		pairs.clear();
+		for (size_t t = 0; t < triangles.size(); t += 3)
+		{
+			uint32_t a = triangles[t], b = triangles[t + 1], c = triangles[t + 2];
+			if (std::max(a, std::max(b, c)) >= unionFind.size())
+			{
+				std::cerr << inputPath << " references a vertex which is not defined before the face" << std::endl;
+				return false;
+			}
+			pairs.emplace_back(a, b);
+			pairs.emplace_back(a, c);
+			used[a] = used[b] = used[c] = true;
+		}
+		unionFind.MergeBatch(pairs);
+	}
+	if (source->Failed())
+		return false;
+
+	//number the shells in the order of their first vertex, afterwards labels[v] is the shell of every used vertex
+	std::vector<int32_t> labels(unionFind.size(), -1);
+	for (size_t v = 0; v < labels.size(); ++v)
+	{
+		if (!used[v])
+			continue;
+		auto root = unionFind.GetRepresentative((nse::util::UnionFind::index_t)v);
+		if (labels[root] < 0)
+		{
+			labels[root] = (int32_t)shells.size();
+			shells.emplace_back();
+		}
+		labels[v] = labels[root];
+	}
+	unionFind.Clear();
+	used = std::vector<bool>();
+
+	//second pass: write the shell of every face and collect the summaries
+	FILE* output = fopen(shellIdPath.c_str(), "wb");
+	if (output == nullptr)
+	{
+		std::cerr << "Cannot create " << shellIdPath << std::endl;
+		return false;
+	}
+	bool writeFailed = false;
+	std::vector<int32_t> faceShells;
+	if (!source->Rewind())
+	{
+		std::cerr << "Cannot read " << inputPath << std::endl;
+		fclose(output);
+		return false;
+	}
+	while (source->NextChunk(xyz, firstVertex, triangles))
+	{
+		for (size_t i = 0; i < xyz.size() / 3; ++i)
+		{
+			int32_t shell = labels[(size_t)firstVertex + i];
+			if (shell < 0)
+				continue;
+			StreamingShell& s = shells[shell];
+			++s.numVertices;
+			for (int d = 0; d < 3; ++d)
+			{
+				s.lower[d] = std::min(s.lower[d], xyz[3 * i + d]);
+				s.upper[d] = std::max(s.upper[d], xyz[3 * i + d]);
+			}
+		}
+
+		faceShells.resize(triangles.size() / 3);
+		for (size_t t = 0; t < faceShells.size(); ++t)
+		{
+			faceShells[t] = labels[triangles[3 * t]];
+			++shells[faceShells[t]].numFaces;
+		}
+		if (fwrite(faceShells.data(), sizeof(int32_t), faceShells.size(), output) != faceShells.size())
+			writeFailed = true;
+	}
+	if (fclose(output) != 0)
+		writeFailed = true;
+	if (writeFailed)
+		std::cerr << "Cannot write " << shellIdPath << std::endl;
+	return !writeFailed && !source->Failed();
+}
@@ -7,6 +7,15 @@
 #include <random>
 #include "sample_set.h"
 #include <queue>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <climits>
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+#include <util/ThreadPool.h>
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> HEMesh;
 typedef OpenMesh::FaceHandle FH;
@@ -40,186 +49,584 @@ HEMesh::HalfedgeHandle getHypotenuse(const HEMesh& mesh, const HEMesh::FaceHandl
     return longest_he;  // Return the longest edge
 }
 
-int traverseForwardStrip(HEMesh& mesh,
-    OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
-    sample_set<OpenMesh::FaceHandle>& my_set, sample_set<OpenMesh::FaceHandle>& forward_set,
-    HEMesh::HalfedgeHandle& hei_init,
-    int nStrips,
-    int parity)
+// Marks of the faces of a trial strip. Instead of resetting the marks after every trial, the epoch is
+// incremented, so a trial does not modify the mesh and every thread can evaluate trials with its own marker.
+struct StripMarker
 {
-    int nTriangles = 0;
-    while (!mesh.is_boundary(hei_init) &&
-        mesh.property(perFaceStripIdProperty, mesh.opposite_face_handle(hei_init)) == -1) {
-        mesh.property(perFaceStripIdProperty, mesh.opposite_face_handle(hei_init)) = nStrips;
-        forward_set.insert(mesh.opposite_face_handle(hei_init));
-        //my_set.remove(mesh.opposite_face_handle(hei_init));
-        // Move forward along the edge based on parity
-        if (parity == 0) {
-            hei_init = mesh.prev_halfedge_handle(mesh.opposite_halfedge_handle(hei_init));
+    std::vector<unsigned int> marks;
+    unsigned int epoch = 0;
+
+    // Starts a new strip, afterwards no face is marked
+    void begin(size_t nFaces)
+    {
+        if (marks.size() < nFaces) {
+            marks.assign(nFaces, 0);
+            epoch = 0;
         }
-        else {
-            hei_init = mesh.next_halfedge_handle(mesh.opposite_halfedge_handle(hei_init));
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
         }
-        parity = 1 - parity;
-        nTriangles++;
     }
 
-    for (const auto& face : forward_set.elements) {
-        mesh.property(perFaceStripIdProperty, face) = -1;
-    }
-    return nTriangles;
-}
+    bool isMarked(FH f) const { return marks[f.idx()] == epoch; }
+    void mark(FH f) { marks[f.idx()] = epoch; }
+};
 
-int traverseBackwardStrip(HEMesh& mesh,
+// Walks a strip starting across hei_init with alternating turns and returns its number of faces. Faces are free
+// if they are not assigned to a strip and not visited by this walk. hei_init is moved to the last face of the strip.
+// The forward walk continues at the opposite face of each exit, the backward walk at the face behind the previous
+// edge. If faces is given, it receives the faces of the strip.
+int walkStrip(const HEMesh& mesh,
     OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
-    sample_set<OpenMesh::FaceHandle>& my_set, sample_set<OpenMesh::FaceHandle>& backward_set,
+    StripMarker& marker,
     HEMesh::HalfedgeHandle& hei_init,
-    int nStrips,
-    int parity)
+    int parity,
+    bool forward,
+    std::vector<OpenMesh::FaceHandle>* faces)
 {
+    marker.begin(mesh.n_faces());
     int nTriangles = 0;
-    while (!mesh.is_boundary(hei_init) &&
-        mesh.property(perFaceStripIdProperty, mesh.opposite_face_handle(hei_init)) == -1) {
-        mesh.property(perFaceStripIdProperty, mesh.opposite_face_handle(hei_init)) = nStrips;
-        backward_set.insert(mesh.opposite_face_handle(hei_init));
-
-        // Move backward along the edge based on parity
-        if (parity == 0) {
-            hei_init = mesh.opposite_halfedge_handle(mesh.prev_halfedge_handle(hei_init));
+    while (!mesh.is_boundary(hei_init)) {
+        FH face = mesh.opposite_face_handle(hei_init);
+        if (!face.is_valid() || mesh.property(perFaceStripIdProperty, face) != -1 || marker.isMarked(face))
+            break;
+        marker.mark(face);
+        if (faces)
+            faces->push_back(face);
+
+        // Move along the edge based on parity
+        if (forward) {
+            if (parity == 0) {
+                hei_init = mesh.prev_halfedge_handle(mesh.opposite_halfedge_handle(hei_init));
+            }
+            else {
+                hei_init = mesh.next_halfedge_handle(mesh.opposite_halfedge_handle(hei_init));
+            }
         }
         else {
-            hei_init = mesh.opposite_halfedge_handle(mesh.next_halfedge_handle(hei_init));
+            if (parity == 0) {
+                hei_init = mesh.opposite_halfedge_handle(mesh.prev_halfedge_handle(hei_init));
+            }
+            else {
+                hei_init = mesh.opposite_halfedge_handle(mesh.next_halfedge_handle(hei_init));
+            }
         }
         parity = 1 - parity;
         nTriangles++;
     }
-
-    // Reset the property of the faces in the backward set
-    for (const auto& face : backward_set.elements) {
-        mesh.property(perFaceStripIdProperty, face) = -1;
-    }
     return nTriangles;
 }
 
+// Result of a single trial
+struct StripTrial
+{
+    OpenMesh::FaceHandle start_face;
+    int forward_triangles = 0;
+    int backward_triangles = 0;
+};
+
+// Evaluates a trial: the forward strip from the hypotenuse of the start face and the backward strip from the
+// end of the forward strip
+void evaluateTrial(const HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, StripMarker& marker, StripTrial& trial)
+{
+    HEMesh::HalfedgeHandle hei_init = getHypotenuse(mesh, trial.start_face);
+    trial.forward_triangles = walkStrip(mesh, perFaceStripIdProperty, marker, hei_init, 0, true, nullptr);
+    trial.backward_triangles = walkStrip(mesh, perFaceStripIdProperty, marker, hei_init, 0, false, nullptr);
+}
+
+// Collects the faces of the strip of a trial in the given direction ('f' or 'b')
+void collectTrialStrip(const HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, StripMarker& marker,
+    const StripTrial& trial, char direction, std::vector<OpenMesh::FaceHandle>& faces)
+{
+    HEMesh::HalfedgeHandle hei_init = getHypotenuse(mesh, trial.start_face);
+    walkStrip(mesh, perFaceStripIdProperty, marker, hei_init, 0, true, direction == 'f' ? &faces : nullptr);
+    if (direction == 'b')
+        walkStrip(mesh, perFaceStripIdProperty, marker, hei_init, 0, false, &faces);
+}
+
+// Samples nTrials start faces and evaluates them, in parallel if a pool is given. The trials are split into
+// markers.size() contiguous groups, each evaluated with its own marker. The trial results only depend on the
+// start faces, and the best trial is selected in sampling order, so the result only depends on the random engine.
+// FaceSet is sample_set<OpenMesh::FaceHandle> or hashed_sample_set<OpenMesh::FaceHandle>, for comparison
+template <typename FaceSet>
 void findStartFace(
-    HEMesh& mesh,
+    const HEMesh& mesh,
     OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
-    sample_set<OpenMesh::FaceHandle>& my_set,
+    FaceSet& my_set,
     std::mt19937& eng,
     unsigned int nTrials,
+    nse::util::ThreadPool* pool,
+    std::vector<StripTrial>& trials,
+    std::vector<StripMarker>& markers,
     int& max_traingles,
-    OpenMesh::FaceHandle& start_face,
-    char& direction, sample_set<OpenMesh::FaceHandle>& forward_set, sample_set<OpenMesh::FaceHandle>& backward_set,
-    int nStrips)
+    size_t& best_trial,
+    char& direction)
 {
-    // Run the specified number of trials
-    for (unsigned int trial = 0; trial < nTrials; ++trial) {
-        if (my_set.empty()) {
-            break;  // If no more faces to sample from, stop.
-        }
-        int parity = 0;
-
-        // Sample a random face from the set
-        OpenMesh::FaceHandle random_face = my_set.sample(eng);
-        if (mesh.property(perFaceStripIdProperty, random_face) == -1) {
-            // Increment strip index
-            nStrips++;
-
-            // Get the longest edge (hypotenuse) of the random face to start
-            HEMesh::HalfedgeHandle hei_init = getHypotenuse(mesh, random_face);
-
-            // Initialize temp_Sets
-            sample_set<OpenMesh::FaceHandle> forward_trial_set;
-            sample_set<OpenMesh::FaceHandle> backward_trial_set;
-
-            // Traverse the half-edges of the current strip (FORWARD)
-            int forward_triangles = traverseForwardStrip(mesh, perFaceStripIdProperty, my_set, forward_trial_set, hei_init, nStrips, parity);
-            if (!forward_set.empty()) {
-                std::cout << forward_triangles << std::endl;
-            }
+    // Sample the start faces from the set
+    trials.resize(nTrials);
+    for (unsigned int trial = 0; trial < nTrials; ++trial)
+        trials[trial].start_face = my_set.sample(eng);
 
-            // Reverse traversal (BACKWARD) to create the strip in the opposite direction
-            parity = 0; // Reset parity for backward direction
-            int backward_triangles = traverseBackwardStrip(mesh, perFaceStripIdProperty, my_set, backward_trial_set, hei_init, nStrips, parity);
-            if (!backward_set.empty()) {
-                std::cout << backward_triangles << std::endl;
-            }
+    // Run the trials
+    if (pool && markers.size() > 1) {
+        size_t nGroups = markers.size();
+        pool->ParallelFor(nGroups, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t group = begin; group < end; ++group)
+                for (size_t trial = nTrials * group / nGroups; trial < nTrials * (group + 1) / nGroups; ++trial)
+                    evaluateTrial(mesh, perFaceStripIdProperty, markers[group], trials[trial]);
+        });
+    }
+    else {
+        for (auto& trial : trials)
+            evaluateTrial(mesh, perFaceStripIdProperty, markers[0], trial);
+    }
 
-            if (forward_triangles >= backward_triangles)
-            {
-                // Compare forward and backward triangles to determine which direction has more triangles
-                if (forward_triangles > max_traingles) {
-                    forward_set = forward_trial_set;
-                    max_traingles = forward_triangles;
-                    start_face = random_face;  // Set start face
-                    direction = 'f';  // Set direction to forward
-                }
+    // Select the first trial with the longest strip
+    for (size_t trial = 0; trial < trials.size(); ++trial) {
+        int forward_triangles = trials[trial].forward_triangles;
+        int backward_triangles = trials[trial].backward_triangles;
+        if (forward_triangles >= backward_triangles)
+        {
+            // Compare forward and backward triangles to determine which direction has more triangles
+            if (forward_triangles > max_traingles) {
+                max_traingles = forward_triangles;
+                best_trial = trial;
+                direction = 'f';  // Set direction to forward
             }
-            else {
-                if (backward_triangles > max_traingles) {
-                    backward_set = backward_trial_set;
-                    max_traingles = backward_triangles;
-                    start_face = random_face;  // Set start face
-                    direction = 'b';  // Set direction to backward
-                }
+        }
+        else {
+            if (backward_triangles > max_traingles) {
+                max_traingles = backward_triangles;
+                best_trial = trial;
+                direction = 'b';  // Set direction to backward
             }
         }
     }
 }
 
-
-unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials)
+template <typename FaceSet>
+unsigned int extractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials,
+    std::mt19937& eng, nse::util::ThreadPool* pool)
 {
-    // Prepare random engine
-    std::mt19937 eng(std::random_device{}());
-    //int nStrips = 0;
+    nTrials = std::max(nTrials, 1u);
 
     // Initialize strip index to -1 for each face
-    sample_set<OpenMesh::FaceHandle> my_set;
+    FaceSet my_set;
     my_set.reserve(mesh.n_faces());
     for (auto f : mesh.faces()) {
         mesh.property(perFaceStripIdProperty, f) = -1;
         my_set.insert(f);
     }
 
+    std::vector<StripTrial> trials;
+    // Every marker holds an entry per face, so there is one per thread that evaluates trials
+    std::vector<StripMarker> markers(pool ? std::min(pool->NumThreads(), nTrials) : 1);
+    std::vector<OpenMesh::FaceHandle> strip_faces;
+
     int nStrips = 0;
     // Run the specified number of trials
     while (!my_set.empty()) {
 
         int max_traingles = -1;
-        OpenMesh::FaceHandle start_face;
+        size_t best_trial = 0;
         char direction = 'n';
-        int parity = 0;
-
-
-        // Initialize temp_Sets
-        sample_set<OpenMesh::FaceHandle> forward_set;
-        sample_set<OpenMesh::FaceHandle> backward_set;
-        // Sample a random face from the set
-        findStartFace(mesh, perFaceStripIdProperty, my_set, eng, nTrials, max_traingles, start_face, direction, forward_set, backward_set, nStrips);
-        OpenMesh::FaceHandle random_face = start_face;
-
-        if (mesh.property(perFaceStripIdProperty, random_face) == -1) {
-            if (direction == 'f')
-            {
-                for (const auto& face : forward_set.elements) {
-                    mesh.property(perFaceStripIdProperty, face) = nStrips;
-                    my_set.remove(face);
+
+        findStartFace(mesh, perFaceStripIdProperty, my_set, eng, nTrials, pool, trials, markers, max_traingles, best_trial, direction);
+
+        strip_faces.clear();
+        collectTrialStrip(mesh, perFaceStripIdProperty, markers[0], trials[best_trial], direction, strip_faces);
+        // A face without free neighbors forms a strip on its own
+        if (strip_faces.empty())
+            strip_faces.push_back(trials[best_trial].start_face);
+
+        for (const auto& face : strip_faces) {
+            mesh.property(perFaceStripIdProperty, face) = nStrips;
+            my_set.remove(face);
+        }
+        nStrips++;
+    }
+
+    return nStrips;
+}
+
+unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials)
+{
+    return ExtractTriStrips(mesh, perFaceStripIdProperty, nTrials, std::random_device{}(), nullptr);
+}
+
+unsigned int ExtractTriStrips(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials,
+    unsigned int seed, nse::util::ThreadPool* pool)
+{
+    // Prepare random engine
+    std::mt19937 eng(seed);
+    return extractTriStrips<sample_set<OpenMesh::FaceHandle>>(mesh, perFaceStripIdProperty, nTrials, eng, pool);
+}
+
+// Number of neighbors of f that are not assigned to a strip yet
+static int countFreeNeighbors(const HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, FH f)
+{
+    int count = 0;
+    for (auto h : mesh.fh_range(f)) {
+        FH neighbor = mesh.opposite_face_handle(h);
+        if (neighbor.is_valid() && mesh.property(perFaceStripIdProperty, neighbor) == -1)
+            count++;
+    }
+    return count;
+}
+
+unsigned int ExtractTriStripsGreedy(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
+    std::vector<OpenMesh::FaceHandle>* stripFaces)
+{
+    if (stripFaces) {
+        stripFaces->clear();
+        stripFaces->reserve(mesh.n_faces());
+    }
+
+    // Step 1: Mark all faces as free and sort them into buckets by their number of free neighbors.
+    // Degrees only decrease, so a face enters every bucket at most once and entries whose degree
+    // has changed since are skipped when they are popped.
+    for (auto f : mesh.faces())
+        mesh.property(perFaceStripIdProperty, f) = -1;
+    std::vector<int> degree(mesh.n_faces());
+    std::vector<std::vector<FH>> buckets(4);
+    for (auto f : mesh.faces()) {
+        int d = countFreeNeighbors(mesh, perFaceStripIdProperty, f);
+        degree[f.idx()] = d;
+        if (d >= (int)buckets.size())
+            buckets.resize(d + 1);
+        buckets[d].push_back(f);
+    }
+    size_t lowestBucket = 0;
+
+    // Assigns a face to a strip and updates the degrees of its free neighbors
+    auto assign = [&](FH f, int strip) {
+        mesh.property(perFaceStripIdProperty, f) = strip;
+        if (stripFaces)
+            stripFaces->push_back(f);
+        for (auto h : mesh.fh_range(f)) {
+            FH neighbor = mesh.opposite_face_handle(h);
+            if (neighbor.is_valid() && mesh.property(perFaceStripIdProperty, neighbor) == -1) {
+                int d = --degree[neighbor.idx()];
+                buckets[d].push_back(neighbor);
+                lowestBucket = std::min(lowestBucket, (size_t)d);
+            }
+        }
+    };
+
+    int nStrips = 0;
+    while (true) {
+        // Step 2: Start a new strip at a free face with the fewest free neighbors
+        while (lowestBucket < buckets.size() && buckets[lowestBucket].empty())
+            lowestBucket++;
+        if (lowestBucket == buckets.size())
+            break;
+        FH face = buckets[lowestBucket].back();
+        buckets[lowestBucket].pop_back();
+        if (mesh.property(perFaceStripIdProperty, face) != -1 || degree[face.idx()] != (int)lowestBucket)
+            continue;
+
+        int strip = nStrips++;
+        assign(face, strip);
+
+        // Step 3: Extend the strip to the free neighbor with the fewest free neighbors. On ties,
+        // prefer the exit which alternates with the previous one and needs no swap in the strip.
+        HH entry;          // halfedge of the current face shared with the previous face
+        int lastTurn = -1; // 0: left (next of entry), 1: right (prev of entry)
+        while (true) {
+            HH candidates[3];
+            int turns[3];
+            int nCandidates = 0;
+            if (entry.is_valid()) {
+                candidates[nCandidates] = mesh.prev_halfedge_handle(entry); turns[nCandidates++] = 1;
+                candidates[nCandidates] = mesh.next_halfedge_handle(entry); turns[nCandidates++] = 0;
+            }
+            else {
+                for (auto h : mesh.fh_range(face)) {
+                    if (nCandidates == 3)
+                        break;
+                    candidates[nCandidates] = h; turns[nCandidates++] = -1;
                 }
             }
-            else if (direction == 'b')
-            {
-                for (const auto& face : backward_set.elements) {
-                    mesh.property(perFaceStripIdProperty, face) = nStrips;
-                    my_set.remove(face);
+
+            HH best;
+            int bestTurn = -1;
+            int bestScore = INT_MAX;
+            for (int i = 0; i < nCandidates; ++i) {
+                FH neighbor = mesh.opposite_face_handle(candidates[i]);
+                if (!neighbor.is_valid() || mesh.property(perFaceStripIdProperty, neighbor) != -1)
+                    continue;
+                int score = 2 * degree[neighbor.idx()] + (lastTurn != -1 && turns[i] == lastTurn ? 1 : 0);
+                if (score < bestScore) {
+                    bestScore = score;
+                    best = candidates[i];
+                    bestTurn = turns[i];
                 }
             }
-            nStrips++;
+            if (!best.is_valid())
+                break;
+
+            face = mesh.opposite_face_handle(best);
+            assign(face, strip);
+            entry = mesh.opposite_halfedge_handle(best);
+            lastTurn = bestTurn;
         }
     }
 
     return nStrips;
 }
 
+// Returns the halfedge of f whose opposite face is g, or an invalid handle if the faces are not adjacent
+static HH sharedHalfedge(const HEMesh& mesh, FH f, FH g)
+{
+    for (auto h : mesh.fh_range(f))
+        if (mesh.opposite_face_handle(h) == g)
+            return h;
+    return HH();
+}
 
+std::vector<uint32_t> BuildTriangleStripIndices(const HEMesh& mesh, const std::vector<OpenMesh::FaceHandle>& stripFaces,
+    OpenMesh::FPropHandleT<int> perFaceStripIdProperty, StripJoin join)
+{
+    std::vector<uint32_t> indices;
+    indices.reserve(stripFaces.size() + 3 * stripFaces.size() / 2);
+    size_t i = 0;
+    while (i < stripFaces.size()) {
+        // Step 1: Find the faces of this strip, consecutive faces with the same id that are adjacent
+        size_t end = i + 1;
+        while (end < stripFaces.size() &&
+            mesh.property(perFaceStripIdProperty, stripFaces[end]) == mesh.property(perFaceStripIdProperty, stripFaces[i]) &&
+            sharedHalfedge(mesh, stripFaces[end - 1], stripFaces[end]).is_valid())
+            end++;
 
+        // Step 2: Order the first triangle such that the edge to the second face comes last, keeping its winding
+        uint32_t first[3];
+        HH exit = end - i > 1 ? sharedHalfedge(mesh, stripFaces[i], stripFaces[i + 1]) : mesh.halfedge_handle(stripFaces[i]);
+        first[0] = mesh.to_vertex_handle(mesh.next_halfedge_handle(exit)).idx();
+        first[1] = mesh.from_vertex_handle(exit).idx();
+        first[2] = mesh.to_vertex_handle(exit).idx();
+
+        // Step 3: Join to the previous strip. A strip has to start at an even position, otherwise
+        // OpenGL flips the winding of all its triangles.
+        if (!indices.empty()) {
+            if (join == StripJoin::PrimitiveRestart)
+                indices.push_back(StripRestartIndex);
+            else {
+                indices.push_back(indices.back());
+                if (indices.size() % 2 == 0)
+                    indices.push_back(indices.back());
+                indices.push_back(first[0]);
+            }
+        }
+        indices.insert(indices.end(), first, first + 3);
+
+        // Step 4: Add one vertex per face. If the next face is attached to the other edge of the new vertex
+        // (a turn in the same direction as the last one), the vertex before the last one is repeated first,
+        // which adds a degenerate triangle and swaps the parity.
+        HH entry = end - i > 1 ? mesh.opposite_halfedge_handle(exit) : HH();
+        for (size_t j = i + 1; j < end; ++j) {
+            uint32_t newVertex = mesh.to_vertex_handle(mesh.next_halfedge_handle(entry)).idx();
+            if (j + 1 < end) {
+                HH next = sharedHalfedge(mesh, stripFaces[j], stripFaces[j + 1]);
+                // next is either the edge from the last strip vertex to the new vertex or the one from the new vertex
+                // to the vertex before the last one
+                uint32_t other = (uint32_t)mesh.from_vertex_handle(next).idx() == newVertex ?
+                    mesh.to_vertex_handle(next).idx() : mesh.from_vertex_handle(next).idx();
+                if (other != indices.back())
+                    indices.push_back(indices[indices.size() - 2]);
+                entry = mesh.opposite_halfedge_handle(next);
+            }
+            indices.push_back(newVertex);
+        }
+        i = end;
+    }
+    return indices;
+}
+
+bool VerifyTriangleStripIndices(const HEMesh& mesh, const std::vector<uint32_t>& indices, StripJoin join, std::ostream& os)
+{
+    // Triangles are compared as index triples rotated such that the smallest index comes first, which keeps the orientation
+    typedef std::array<uint32_t, 3> Triangle;
+    auto canonical = [](uint32_t a, uint32_t b, uint32_t c) {
+        if (b < a && b < c)
+            return Triangle{ { b, c, a } };
+        if (c < a && c < b)
+            return Triangle{ { c, a, b } };
+        return Triangle{ { a, b, c } };
+    };
+
+    std::vector<Triangle> expected;
+    expected.reserve(mesh.n_faces());
+    for (auto f : mesh.faces()) {
+        if (mesh.valence(f) != 3) {
+            os << "Face " << f.idx() << " is not a triangle." << std::endl;
+            return false;
+        }
+        HH h = mesh.halfedge_handle(f);
+        expected.push_back(canonical(mesh.to_vertex_handle(h).idx(), mesh.to_vertex_handle(mesh.next_halfedge_handle(h)).idx(),
+            mesh.from_vertex_handle(h).idx()));
+    }
+
+    // Reconstruct like OpenGL: triangle k of a strip is (s[k], s[k+1], s[k+2]) for even k and (s[k+1], s[k], s[k+2])
+    // for odd k, triangles with a repeated index produce no fragments
+    std::vector<Triangle> reconstructed;
+    reconstructed.reserve(mesh.n_faces());
+    size_t stripStart = 0;
+    for (size_t k = 0; k < indices.size(); ++k) {
+        if (join == StripJoin::PrimitiveRestart && indices[k] == StripRestartIndex) {
+            stripStart = k + 1;
+            continue;
+        }
+        if (indices[k] >= mesh.n_vertices()) {
+            os << "Strip index " << k << " references the invalid vertex " << indices[k] << "." << std::endl;
+            return false;
+        }
+        if (k < stripStart + 2)
+            continue;
+        uint32_t a = indices[k - 2], b = indices[k - 1], c = indices[k];
+        if (a == b || b == c || a == c)
+            continue;
+        if ((k - 2 - stripStart) % 2 == 0)
+            reconstructed.push_back(canonical(a, b, c));
+        else
+            reconstructed.push_back(canonical(b, a, c));
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(reconstructed.begin(), reconstructed.end());
+    std::vector<Triangle> missing, extra;
+    std::set_difference(expected.begin(), expected.end(), reconstructed.begin(), reconstructed.end(), std::back_inserter(missing));
+    std::set_difference(reconstructed.begin(), reconstructed.end(), expected.begin(), expected.end(), std::back_inserter(extra));
+    if (!missing.empty() || !extra.empty()) {
+        os << "The strips miss " << missing.size() << " faces and contain " << extra.size()
+           << " triangles which are not faces (or have the wrong orientation)." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Prints the number of strips, their average and maximum length, and the number of single-triangle strips
+static void printStripStatistics(const char* name, const HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty,
+    unsigned int nStrips, double milliseconds)
+{
+    std::vector<unsigned int> lengths(nStrips, 0);
+    for (auto f : mesh.faces()) {
+        int strip = mesh.property(perFaceStripIdProperty, f);
+        if (strip >= 0 && strip < (int)nStrips)
+            lengths[strip]++;
+    }
+    unsigned int longest = 0, singles = 0;
+    for (auto length : lengths) {
+        longest = std::max(longest, length);
+        if (length == 1)
+            singles++;
+    }
+    std::cout << " - " << name << ":" << std::endl
+              << "     time:           " << milliseconds << "ms" << std::endl
+              << "     strips:         " << nStrips << std::endl
+              << "     average length: " << (nStrips > 0 ? (double)mesh.n_faces() / nStrips : 0.0) << " triangles" << std::endl
+              << "     longest strip:  " << longest << " triangles" << std::endl
+              << "     single triangles: " << singles << std::endl;
+}
+
+// Times inserting all faces, drawing one sample per face and removing all faces
+template <typename FaceSet>
+static void benchmarkFaceSet(const char* name, const std::vector<OpenMesh::FaceHandle>& faces, size_t nFaces, std::mt19937& eng)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto nanosecondsPerFace = [&](Clock::duration d) { return std::chrono::duration<double, std::nano>(d).count() / std::max<size_t>(faces.size(), 1); };
+
+    FaceSet set;
+    auto timeStart = Clock::now();
+    set.reserve(nFaces);
+    for (auto f : faces)
+        set.insert(f);
+    auto insertTime = Clock::now() - timeStart;
+
+    timeStart = Clock::now();
+    for (size_t i = 0; i < faces.size(); ++i)
+        set.sample(eng);
+    auto sampleTime = Clock::now() - timeStart;
+
+    timeStart = Clock::now();
+    for (auto f : faces)
+        set.remove(f);
+    auto removeTime = Clock::now() - timeStart;
+
+    std::cout << " - " << name << " face set: insert " << nanosecondsPerFace(insertTime) << "ns, sample " << nanosecondsPerFace(sampleTime)
+              << "ns, remove " << nanosecondsPerFace(removeTime) << "ns per face" << std::endl;
+}
+
+void BenchmarkStripification(HEMesh& mesh, OpenMesh::FPropHandleT<int> perFaceStripIdProperty, unsigned int nTrials)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::cout << std::fixed << "Stripification benchmark on " << mesh.n_faces() << " faces:" << std::endl;
+
+    // Face sets with one insert, sample and remove per face in random order
+    std::mt19937 eng(42);
+    std::vector<OpenMesh::FaceHandle> faces;
+    faces.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+        faces.push_back(f);
+    std::shuffle(faces.begin(), faces.end(), eng);
+    benchmarkFaceSet<hashed_sample_set<OpenMesh::FaceHandle>>("hashed", faces, mesh.n_faces(), eng);
+    benchmarkFaceSet<sample_set<OpenMesh::FaceHandle>>("dense", faces, mesh.n_faces(), eng);
+
+    // The randomized stripification with both face sets on a single thread and with all threads, the
+    // same seed has to give the same strips in all runs
+    const unsigned int seed = 42;
+    std::mt19937 hashedEng(seed);
+    auto timeStart = Clock::now();
+    unsigned int hashedStrips = extractTriStrips<hashed_sample_set<OpenMesh::FaceHandle>>(mesh, perFaceStripIdProperty, nTrials, hashedEng, nullptr);
+    auto hashedTime = Clock::now() - timeStart;
+    std::string hashedName = "randomized (" + std::to_string(nTrials) + " trials, hashed face set, 1 thread)";
+    printStripStatistics(hashedName.c_str(), mesh, perFaceStripIdProperty, hashedStrips, milliseconds(hashedTime));
+
+    timeStart = Clock::now();
+    unsigned int serialStrips = ExtractTriStrips(mesh, perFaceStripIdProperty, nTrials, seed, nullptr);
+    auto serialTime = Clock::now() - timeStart;
+    std::string serialName = "randomized (" + std::to_string(nTrials) + " trials, dense face set, 1 thread)";
+    printStripStatistics(serialName.c_str(), mesh, perFaceStripIdProperty, serialStrips, milliseconds(serialTime));
+    std::cout << " - speedup of the dense face set: " << milliseconds(hashedTime) / std::max(milliseconds(serialTime), 1e-9) << "x" << std::endl;
+    std::vector<int> serialIds;
+    serialIds.reserve(mesh.n_faces());
+    for (auto f : mesh.faces())
+        serialIds.push_back(mesh.property(perFaceStripIdProperty, f));
+
+    auto pool = nse::util::ThreadPool::Instance();
+    timeStart = Clock::now();
+    unsigned int randomizedStrips = ExtractTriStrips(mesh, perFaceStripIdProperty, nTrials, seed, pool);
+    auto randomizedTime = Clock::now() - timeStart;
+    std::string randomizedName = "randomized (" + std::to_string(nTrials) + " trials, dense face set, " + std::to_string(pool->NumThreads()) + " threads)";
+    printStripStatistics(randomizedName.c_str(), mesh, perFaceStripIdProperty, randomizedStrips, milliseconds(randomizedTime));
+    size_t mismatches = 0;
+    for (auto f : mesh.faces())
+        if (mesh.property(perFaceStripIdProperty, f) != serialIds[f.idx()])
+            mismatches++;
+    std::cout << " - speedup of the parallel trials: " << milliseconds(serialTime) / std::max(milliseconds(randomizedTime), 1e-9) << "x, "
+              << mismatches << " faces differ from the single-threaded result" << std::endl;
+
+    std::vector<OpenMesh::FaceHandle> stripFaces;
+    timeStart = Clock::now();
+    unsigned int greedyStrips = ExtractTriStripsGreedy(mesh, perFaceStripIdProperty, &stripFaces);
+    auto greedyTime = Clock::now() - timeStart;
+    printStripStatistics("greedy", mesh, perFaceStripIdProperty, greedyStrips, milliseconds(greedyTime));
+
+    std::cout << " - speedup of the greedy stripification: " << milliseconds(randomizedTime) / std::max(milliseconds(greedyTime), 1e-9) << "x" << std::endl;
+
+    // MeshRenderer::Update emits three indices per triangle
+    size_t listIndices = 3 * mesh.n_faces();
+    std::cout << " - index count of the GL_TRIANGLES list: " << listIndices << std::endl;
+    for (StripJoin join : { StripJoin::PrimitiveRestart, StripJoin::DegenerateTriangles }) {
+        timeStart = Clock::now();
+        std::vector<uint32_t> indices = BuildTriangleStripIndices(mesh, stripFaces, perFaceStripIdProperty, join);
+        auto buildTime = Clock::now() - timeStart;
+        bool watertight = VerifyTriangleStripIndices(mesh, indices, join, std::cout);
+        std::cout << " - index count of the GL_TRIANGLE_STRIP buffer with "
+                  << (join == StripJoin::PrimitiveRestart ? "primitive restart: " : "degenerate triangles: ") << indices.size()
+                  << " (" << (listIndices > 0 ? 100.0 * indices.size() / listIndices : 0.0) << "% of the list, built in "
+                  << milliseconds(buildTime) << "ms, " << (watertight ? "watertight" : "NOT watertight") << ")" << std::endl;
+    }
+}
@@ -6,6 +6,8 @@
 #include <set>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <algorithm>
 #include "Valence.h"
 
 
@@ -31,17 +33,20 @@ ValenceHistogram ComputeValenceHistogram (const HEMesh &m, const VertexValencePr
 	ValenceHistogram ret;
 	/* Task 1.2.3 - create a histogram of vertex valences from the values stored in your
 	                custom mesh property. */
-		// Compute a histogram for the given vertex valence propert
-		// Iterate over each vertex in the mesh
+		// Count into a dense histogram first, the map only receives the non-empty entries
+		DenseValenceHistogram dense;
 		for (auto v : m.vertices())
 		{
 			// Get the valence (number of incident faces) of the vertex
-			int vertexValence = m.property(valence, v);
+			unsigned vertexValence = (unsigned)std::max(0, m.property(valence, v));
 
 			// Increment the count for this valence in the histogram
-			ret[vertexValence]++;
+			if (vertexValence >= dense.size())
+				dense.resize(vertexValence + 1, 0);
+			dense[vertexValence]++;
 		}
 
+		ret = ToValenceHistogram(dense);
 		return ret;
 }
 
@@ -96,3 +101,89 @@ void ComputeVertexVertexValences (HEMesh &m, const VertexValenceProperty valence
 		m.property(valence, v) = vertexValence;
 	}
 }
+
+void ComputeVertexValences(const FlatMesh& m, std::vector<int>& faceValences, std::vector<int>& vertexValences, nse::util::ThreadPool* pool)
+{
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	size_t numVertices = m.NumVertices();
+	std::vector<std::atomic<int>> faceCounts(numVertices), vertexCounts(numVertices);
+	pool->ParallelFor(numVertices, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (size_t v = begin; v < end; ++v)
+		{
+			faceCounts[v].store(0, std::memory_order_relaxed);
+			vertexCounts[v].store(0, std::memory_order_relaxed);
+		}
+	});
+
+	// every face corner adds an incident face, every owned edge an adjacent vertex to both of its ends
+	pool->ParallelForChunks(m.NumFaces(), 4096, [&](size_t begin, size_t end)
+	{
+		for (size_t f = begin; f < end; ++f)
+		{
+			uint32_t first = m.faceOffsets[f], last = m.faceOffsets[f + 1];
+			for (uint32_t k = first; k < last; ++k)
+			{
+				uint32_t v = m.faceVertices[k];
+				faceCounts[v].fetch_add(1, std::memory_order_relaxed);
+				if (m.ownsEdge[k])
+				{
+					uint32_t next = m.faceVertices[k + 1 < last ? k + 1 : first];
+					vertexCounts[v].fetch_add(1, std::memory_order_relaxed);
+					vertexCounts[next].fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+	});
+
+	faceValences.resize(numVertices);
+	vertexValences.resize(numVertices);
+	pool->ParallelFor(numVertices, [&](size_t begin, size_t end, unsigned int)
+	{
+		for (size_t v = begin; v < end; ++v)
+		{
+			faceValences[v] = faceCounts[v].load(std::memory_order_relaxed);
+			vertexValences[v] = vertexCounts[v].load(std::memory_order_relaxed);
+		}
+	});
+}
+
+DenseValenceHistogram ComputeDenseValenceHistogram(const std::vector<int>& valences, nse::util::ThreadPool* pool)
+{
+	if (pool == nullptr)
+		pool = nse::util::ThreadPool::Instance();
+
+	std::vector<DenseValenceHistogram> partHistograms(pool->NumThreads());
+	pool->ParallelFor(valences.size(), [&](size_t begin, size_t end, unsigned int part)
+	{
+		DenseValenceHistogram& histogram = partHistograms[part];
+		for (size_t v = begin; v < end; ++v)
+		{
+			unsigned valence = (unsigned)std::max(0, valences[v]);
+			if (valence >= histogram.size())
+				histogram.resize(valence + 1, 0);
+			++histogram[valence];
+		}
+	});
+
+	DenseValenceHistogram result;
+	for (auto& histogram : partHistograms)
+	{
+		if (histogram.size() > result.size())
+			result.resize(histogram.size(), 0);
+		for (size_t i = 0; i < histogram.size(); ++i)
+			result[i] += histogram[i];
+	}
+	return result;
+}
+
+ValenceHistogram ToValenceHistogram(const DenseValenceHistogram& histogram)
+{
+	ValenceHistogram ret;
+	for (size_t valence = 0; valence < histogram.size(); ++valence)
+		if (histogram[valence] != 0)
+			ret[(unsigned)valence] = histogram[valence];
+	return ret;
+}
@@ -13,14 +13,18 @@
 #include <nanogui/combobox.h>
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 
 #include <OpenMesh/Core/IO/MeshIO.hh>
 
 #include <gui/SliderHelper.h>
+#include <util/VertexCache.h>
 
 #include "Primitives.h"
 #include "SurfaceArea.h"
 #include "Volume.h"
+#include "MeshReductions.h"
 #include "ShellExtraction.h"
 #include "Smoothing.h"
 #include "Stripification.h"
@@ -66,11 +70,12 @@ void Viewer::SetupGUI()
 	loadFileBtn->setCallback([this]() {
 		std::vector<std::pair<std::string, std::string>> fileTypes;
 		fileTypes.push_back(std::make_pair("obj", "OBJ File"));
+		fileTypes.push_back(std::make_pair("itri", "Indexed Triangle File"));
 		auto file = nanogui::file_dialog(fileTypes, false);
 		if (!file.empty())
 		{
 			polymesh.clear();
-			if (!OpenMesh::IO::read_mesh(polymesh, file))
+			if (!ReadMeshFile(file, polymesh))
 			{
 				new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Warning, "Load Mesh",
 					"The specified file could not be loaded");
@@ -110,6 +115,15 @@ void Viewer::SetupGUI()
 	auto torusBtn = new nanogui::Button(primitiveBtn->popup(), "Torus");
 	torusBtn->setCallback([this]() { CreateTorus(polymesh, 0.4f, 1, 20, 20); MeshUpdated(true); });
 
+	auto benchmarkPrimitivesBtn = new nanogui::Button(primitiveBtn->popup(), "Benchmark Generators");
+	benchmarkPrimitivesBtn->setCallback([this]() {
+		//about one million faces per primitive
+		BenchmarkPrimitiveGeneration(polymesh, 1000);
+		MeshUpdated(true);
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Benchmark Generators",
+			"Done! Check console output.");
+	});
+
 	auto arrowBtn = new nanogui::Button(primitiveBtn->popup(), "Arrow");
 	arrowBtn->setCallback([this]() { CreateUnitArrow(polymesh); MeshUpdated(true); });
 
@@ -139,7 +153,7 @@ void Viewer::SetupGUI()
 
 	auto calcAreaBtn = new nanogui::Button(mainWindow, "Calculate Mesh Area");
 	calcAreaBtn->setCallback([this]() {
-		auto area = ComputeSurfaceArea(polymesh);
+		auto area = Statistics().surfaceArea;
 		std::stringstream ss;
 		ss << "The mesh has an area of " << area << ".";
 		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Surface Area",
@@ -157,13 +171,31 @@ void Viewer::SetupGUI()
 			break;
 		}
 		
-		auto vol = ComputeVolume(polymesh);
+		auto vol = std::abs(Statistics().signedVolume);
 		std::stringstream ss;
 		ss << "The mesh has a volume of " << vol << ".";
 		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Volume",
 			ss.str());
 	});
 
+	auto statisticsBtn = new nanogui::Button(mainWindow, "Show Mesh Statistics");
+	statisticsBtn->setCallback([this]() {
+		const auto timeStart = std::chrono::high_resolution_clock::now();
+		const MeshStatistics& stats = Statistics();
+		const auto timeEnd = std::chrono::high_resolution_clock::now();
+		std::cout << "Mesh statistics (" << std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeStart).count()
+		          << "ms, zero if cached):" << std::endl << stats;
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Mesh Statistics",
+			"Done! Check console output.");
+	});
+
+	auto benchmarkAreaVolumeBtn = new nanogui::Button(mainWindow, "Benchmark Area and Volume");
+	benchmarkAreaVolumeBtn->setCallback([this]() {
+		BenchmarkAreaAndVolume(polymesh);
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Benchmark Area and Volume",
+			"Done! Check console output.");
+	});
+
 	auto calcValenceBtn = new nanogui::Button(mainWindow, "Compute Vertex Valences");
 	calcValenceBtn->setCallback([this]() {
 		// compute
@@ -180,17 +212,36 @@ void Viewer::SetupGUI()
 				const auto timeEnd = std::chrono::high_resolution_clock::now();
 				return timeEnd - timeStart;
 			}();
+		// compute both valences in one parallel pass over the flat face arrays
+		std::vector<int> flatVF, flatVV;
+		const auto convertStart = std::chrono::high_resolution_clock::now();
+		const FlatMesh flat(polymesh);
+		const auto parallelStart = std::chrono::high_resolution_clock::now();
+		ComputeVertexValences(flat, flatVF, flatVV);
+		const auto parallelEnd = std::chrono::high_resolution_clock::now();
+		const auto convertTime = parallelStart - convertStart, parallelTime = parallelEnd - parallelStart;
+		size_t mismatches = 0;
+		for (auto v : polymesh.vertices())
+			if (flatVF[v.idx()] != polymesh.property(vertexFaceValenceProperty, v) ||
+			    flatVV[v.idx()] != polymesh.property(vertexVertexValenceProperty, v))
+				++mismatches;
+		auto ms = [](std::chrono::high_resolution_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
 		// output timing info
 		std::cout << std::fixed << "Vertex valence computation timings for " << polymesh.n_vertices()
 		          << " vertices in "<<polymesh.n_faces()<<" faces:" << std::endl
 		          << " - vertex-face incidences took "
 		          << std::chrono::duration_cast<std::chrono::milliseconds>(vfTime).count()<<"ms" << std::endl
 		          << " - vertex-vertex adjacencies took "
-		          << std::chrono::duration_cast<std::chrono::milliseconds>(vvTime).count()<<"ms" << std::endl;
+		          << std::chrono::duration_cast<std::chrono::milliseconds>(vvTime).count()<<"ms" << std::endl
+		          << " - both in one parallel pass took " << ms(parallelTime) << "ms on "
+		          << nse::util::ThreadPool::Instance()->NumThreads() << " threads (speedup "
+		          << ms(vfTime + vvTime) / std::max(ms(parallelTime), 1e-6) << "x, "
+		          << ms(vfTime + vvTime) / std::max(ms(parallelTime + convertTime), 1e-6) << "x including the "
+		          << ms(convertTime) << "ms conversion to a flat mesh), " << mismatches << " mismatching vertices" << std::endl;
 		// compute histograms
 		const ValenceHistogram
-			histVF = ComputeValenceHistogram(polymesh, vertexFaceValenceProperty),
-			histVV = ComputeValenceHistogram(polymesh, vertexVertexValenceProperty);
+			histVF = ToValenceHistogram(ComputeDenseValenceHistogram(flatVF)),
+			histVV = ToValenceHistogram(ComputeDenseValenceHistogram(flatVV));
 		// format output
 		std::cout << "Histogram:"<<std::endl
 		          << std::right<<std::setw(20)<<"[Face incidences]"
@@ -228,7 +279,38 @@ void Viewer::SetupGUI()
 
 	auto extractShellsBtn = new nanogui::Button(mainWindow, "Extract Shells");
 	extractShellsBtn->setCallback([this]() {
-		auto count = ExtractShells(polymesh, faceIdProperty);
+		// compare the breadth-first search with the parallel union-find extraction
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		ExtractShells(polymesh, faceIdProperty);
+		const auto bfsTime = std::chrono::high_resolution_clock::now() - timeStart;
+		std::vector<int> bfsIds(polymesh.n_faces());
+		for (auto f : polymesh.faces())
+			bfsIds[f.idx()] = polymesh.property(faceIdProperty, f);
+
+		std::vector<ShellInfo> shells;
+		timeStart = std::chrono::high_resolution_clock::now();
+		auto count = ExtractShellsParallel(polymesh, faceIdProperty, &shells);
+		const auto parallelTime = std::chrono::high_resolution_clock::now() - timeStart;
+		size_t mismatches = 0;
+		for (auto f : polymesh.faces())
+			mismatches += bfsIds[f.idx()] != polymesh.property(faceIdProperty, f);
+
+		auto ms = [](std::chrono::high_resolution_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+		std::cout << std::fixed << "Shell extraction for " << polymesh.n_faces() << " faces:" << std::endl
+		          << " - breadth-first search took " << ms(bfsTime) << "ms" << std::endl
+		          << " - parallel union-find took " << ms(parallelTime) << "ms on " << nse::util::ThreadPool::Instance()->NumThreads()
+		          << " threads (" << mismatches << " mismatching faces)" << std::endl;
+		// list the largest shells
+		std::vector<unsigned int> order(shells.size());
+		for (unsigned int i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return shells[a].numFaces > shells[b].numFaces; });
+		for (size_t i = 0; i < std::min<size_t>(order.size(), 10); ++i)
+		{
+			const ShellInfo& shell = shells[order[i]];
+			std::cout << "   shell " << order[i] << ": " << shell.numFaces << " faces, bounding box "
+			          << shell.bbox.min.transpose() << " - " << shell.bbox.max.transpose() << std::endl;
+		}
 		std::stringstream ss;
 		ss << "The mesh has " << count << " shells.";
 		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Shell Extraction",
@@ -254,8 +336,7 @@ void Viewer::SetupGUI()
 	
 	auto smoothLBtn = new nanogui::Button(mainWindow, "Uniform Laplacian Smoothing");
 	smoothLBtn->setCallback([this]() {
-		for (unsigned i=0; i<smoothingIterations; i++)
-			SmoothUniformLaplacian(polymesh, sldSmoothingStrength->value());
+		SmoothUniformLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations);
 		MeshUpdated();
 	});
 
@@ -269,11 +350,43 @@ void Viewer::SetupGUI()
 			MeshUpdated();
 			break;
 		}
-		for (unsigned i=0; i<smoothingIterations; i++)
-			SmoothCotanLaplacian(polymesh, sldSmoothingStrength->value());
+		SmoothCotanLaplacian(polymesh, sldSmoothingStrength->value(), smoothingIterations);
 		MeshUpdated();
 	});
 
+	auto smoothImplicitBtn = new nanogui::Button(mainWindow, "Implicit Uniform Smoothing");
+	smoothImplicitBtn->setCallback([this]() {
+		//a single backward Euler step over the time of all explicit iterations
+		float timeStep = sldSmoothingStrength->value() * smoothingIterations;
+		if (!implicitSmoothing.SmoothUniform(polymesh, timeStep))
+		{
+			new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Warning, "Implicit Smoothing",
+				"The linear system could not be solved.");
+			return;
+		}
+		std::cout << std::fixed << "Implicit smoothing with time step " << timeStep << " on " << polymesh.n_vertices() << " vertices:" << std::endl
+		          << " - symbolic analysis took " << implicitSmoothing.LastAnalysisTime() << "ms" << std::endl
+		          << " - factorization took " << implicitSmoothing.LastFactorizationTime() << "ms" << std::endl
+		          << " - solve took " << implicitSmoothing.LastSolveTime() << "ms" << std::endl;
+		MeshUpdated();
+	});
+
+	auto benchmarkSmoothingBtn = new nanogui::Button(mainWindow, "Benchmark Smoothing");
+	benchmarkSmoothingBtn->setCallback([this]() {
+		for (auto f : polymesh.faces()) if (polymesh.valence(f) > 3)
+		{
+			std::cout << "Triangulating mesh." << std::endl;
+			polymesh.triangulate();
+			MeshUpdated();
+			break;
+		}
+		BenchmarkSmoothing(polymesh, sldSmoothingStrength->value(), 100);
+		BenchmarkSmoothingScaling(polymesh, sldSmoothingStrength->value(), 100);
+		BenchmarkDegenerateSmoothing(polymesh, sldSmoothingStrength->value(), smoothingIterations);
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Benchmark Smoothing",
+			"Done! Check console output.");
+	});
+
 	nanogui::TextBox* txtStripificationTrials;
 	auto sldStripificationTrials = nse::gui::AddLabeledSlider(mainWindow, "Stripification Trials", std::make_pair(1, 50), 20, txtStripificationTrials);
 	sldStripificationTrials->setCallback([this, txtStripificationTrials](float value)
@@ -306,8 +419,83 @@ void Viewer::SetupGUI()
 		ColorMeshFromIds();
 	});
 
+	auto greedyStripifyBtn = new nanogui::Button(mainWindow, "Extract Greedy Triangle Strips");
+	greedyStripifyBtn->setCallback([this]() {
+		//Triangulate the mesh if it is not a triangle mesh
+		for (auto f : polymesh.faces())
+		{
+			if (polymesh.valence(f) > 3)
+			{
+				std::cout << "Triangulating mesh." << std::endl;
+				polymesh.triangulate();
+				MeshUpdated();
+				break;
+			}
+		}
+
+		auto count = ExtractTriStripsGreedy(polymesh, faceIdProperty);
+		std::stringstream ss;
+		ss << "The mesh has " << count << " triangle strips.";
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Stripification",
+			ss.str());
+
+		ColorMeshFromIds();
+	});
+
+	auto benchmarkStripifyBtn = new nanogui::Button(mainWindow, "Benchmark Stripification");
+	benchmarkStripifyBtn->setCallback([this]() {
+		for (auto f : polymesh.faces()) if (polymesh.valence(f) > 3)
+		{
+			std::cout << "Triangulating mesh." << std::endl;
+			polymesh.triangulate();
+			MeshUpdated();
+			break;
+		}
+		BenchmarkStripification(polymesh, faceIdProperty, stripificationTrials);
+		ColorMeshFromIds();
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Benchmark Stripification",
+			"Done! Check console output.");
+	});
+
 	shadingBtn = new nanogui::ComboBox(mainWindow, { "Flat Shading", "Smooth Shading" });
 
+	auto chkOptimizeVertexCache = new nanogui::CheckBox(mainWindow, "Optimize Vertex Cache");
+	chkOptimizeVertexCache->setCallback([this](bool checked) {
+		renderer.SetOptimizeVertexCache(checked);
+		MeshUpdated();
+	});
+
+	auto vertexCacheBtn = new nanogui::Button(mainWindow, "Vertex Cache Statistics");
+	vertexCacheBtn->setCallback([this]() {
+		typedef std::chrono::high_resolution_clock Clock;
+		auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+		//simulate the triangle list of MeshRenderer::Update before and after the optimization
+		std::vector<uint32_t> indices = TriangleListIndices(polymesh);
+		std::vector<uint32_t> optimized = indices;
+		auto timeStart = Clock::now();
+		nse::util::OptimizeVertexCache(optimized, polymesh.n_vertices());
+		auto cacheTime = Clock::now() - timeStart;
+		timeStart = Clock::now();
+		nse::util::OptimizeVertexFetch(optimized, polymesh.n_vertices());
+		auto fetchTime = Clock::now() - timeStart;
+
+		std::cout << std::fixed << "Post-transform vertex cache for " << indices.size() / 3 << " triangles (optimization took "
+		          << milliseconds(cacheTime) << "ms, vertex fetch reordering " << milliseconds(fetchTime) << "ms):" << std::endl;
+		for (auto model : { nse::util::VertexCacheModel::FIFO, nse::util::VertexCacheModel::LRU })
+		{
+			for (unsigned int cacheSize : { 16u, 32u })
+			{
+				auto before = nse::util::SimulateVertexCache(indices, polymesh.n_vertices(), model, cacheSize);
+				auto after = nse::util::SimulateVertexCache(optimized, polymesh.n_vertices(), model, cacheSize);
+				std::cout << " - " << (model == nse::util::VertexCacheModel::FIFO ? "FIFO" : "LRU ") << " with " << cacheSize << " entries: "
+				          << "ACMR " << before.ACMR() << " -> " << after.ACMR() << ", ATVR " << before.ATVR() << " -> " << after.ATVR() << std::endl;
+			}
+		}
+		new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Information, "Vertex Cache Statistics",
+			"Done! Check console output.");
+	});
+
 	performLayout();
 }
 
@@ -329,25 +517,29 @@ void Viewer::ColorMeshFromIds()
 	MeshUpdated();
 }
 
+const MeshStatistics& Viewer::Statistics()
+{
+	if (!meshStatisticsValid)
+	{
+		meshStatistics = ComputeMeshStatistics(polymesh);
+		meshStatisticsValid = true;
+	}
+	return meshStatistics;
+}
+
 void Viewer::MeshUpdated(bool initNewMesh)
 {
+	meshStatisticsValid = false;
+
 	if (initNewMesh)
 	{
 		hasColors = false;
 
-		//calculate the bounding box of the mesh
-		nse::math::BoundingBox<float, 3> bbox;
-		for (const auto v : polymesh.vertices())
-			bbox.expand(ToEigenVector(polymesh.point(v)));
-		polymesh.property(bboxProperty) = bbox;
-
-		// calculate average edge length
-		polymesh.property(avgEdgeLengthProperty) = .0f;
-		for (const auto e : polymesh.edges())
-			polymesh.property(avgEdgeLengthProperty) +=
-				(polymesh.point(e.v1()) - polymesh.point(e.v0())).length();
-		polymesh.property(avgEdgeLengthProperty) /= polymesh.n_edges();
-		camera().FocusOnBBox(bbox);
+		//bounding box and average edge length come from the statistics pass
+		const MeshStatistics& stats = Statistics();
+		polymesh.property(bboxProperty) = stats.bbox;
+		polymesh.property(avgEdgeLengthProperty) = stats.meanEdgeLength;
+		camera().FocusOnBBox(stats.bbox);
 	}	
 
 	if (hasColors)
@@ -6,12 +6,15 @@
 
 #include <queue>
 #include <utility>
+#include <algorithm>
+#include <limits>
 
 #include <util/OpenMeshUtils.h>
 #include "Box.h"
 #include "Triangle.h"
 #include "LineSegment.h"
 #include "Point.h"
+#include "QueryStats.h"
 
 
 /**
@@ -168,6 +171,11 @@ private:
 		float sqrDistance;
 		//node
 		const AABBNode* node;
+
+		//default constructor
+		SearchEntry()
+			: sqrDistance(std::numeric_limits<float>::infinity()), node(nullptr)
+		{ }
 		
 		//constructor
 		SearchEntry(float sqrDistance, const AABBNode* node)
@@ -203,6 +211,37 @@ private:
 		}
 	};
 
+public:
+	//maximal supported tree depth, bounds the explicit stack of the depth-first query
+	static constexpr int MaxTraversalDepth = 64;
+
+	//reusable scratch memory of the nearest and k nearest primitive queries
+	//the buffers keep their capacity between queries, so a context that is reused 
+	//across queries does not allocate any more memory once it has grown to the required size
+	class QueryContext
+	{
+		friend class AABBTree;
+		//binary heap of nodes ordered by their distance to the query point
+		std::vector<SearchEntry> nodeHeap;
+		//binary heap of the k best primitives of k nearest primitive queries
+		std::vector<ResultEntry> resultHeap;
+	public:
+		//constructor, preallocates space for capacity heap entries
+		QueryContext(size_t capacity = 256)
+		{
+			nodeHeap.reserve(capacity);
+			resultHeap.reserve(capacity);
+		}
+	};
+
+	//returns the query context of the calling thread which is used by all queries that are not given an explicit context
+	static QueryContext& DefaultQueryContext()
+	{
+		thread_local QueryContext context;
+		return context;
+	}
+
+private:
 	//list of all primitives in the tree
 	primitive_list primitives;
 	//maximum allowed tree depth to stop tree construction
@@ -234,7 +273,7 @@ public:
 	//default  maximal tree depth is 20 
 	//default minimal size of a node not to be further subdivided in the cnstruction process is two 
 	AABBTree(int maxDepth=20, int minSize=2):
-		maxDepth(maxDepth),minSize(minSize),root(nullptr),completed(false)
+		maxDepth(std::min(maxDepth, MaxTraversalDepth - 1)),minSize(minSize),root(nullptr),completed(false)
 	{
 		
 	}
@@ -363,18 +402,19 @@ public:
 			float dist = pit->SqrDistance(q);
 			if(k_best.size() < k )
 			{
-				k_best.push(ResultEntry(dist,*pit));
+				k_best.push(ResultEntry(dist,&(*pit)));
 				continue;
 			}
-			if(k_best.top().SqrDistance > dist)
+			if(k_best.top().sqrDistance > dist)
 			{
 				k_best.pop();
-				k_best.push(ResultEntry(dist,*pit));
+				k_best.push(ResultEntry(dist,&(*pit)));
 			}				
 		}
+		//the queue returns the farthest entry first, fill the result from the back to sort it by increasing distance
 		std::vector<ResultEntry> result(k_best.size());
-		auto rend = result.end();
-		for(auto rit = result.begin(); rit != rend; ++rit)
+		auto rend = result.rend();
+		for(auto rit = result.rbegin(); rit != rend; ++rit)
 		{
 			*rit = k_best.top();
 			k_best.pop();
@@ -383,32 +423,113 @@ public:
 
 	}
 	
-	//closest k primitive computation 
+	//closest k primitive computation, the result is sorted by increasing distance
 	std::vector<ResultEntry> ClosestKPrimitives(size_t k,const Eigen::Vector3f& q) const
 	{
-		//student begin
-		return ClosestKPrimitivesLinearSearch(k,q);
-		//student end
+		NoQueryStats stats;
+		return ClosestKPrimitives(k, q, stats);
+	}
+
+	//closest k primitive computation which records its work in stats (see QueryStats)
+	template <typename Stats>
+	std::vector<ResultEntry> ClosestKPrimitives(size_t k, const Eigen::Vector3f& q, Stats& stats) const
+	{
+		return ClosestKPrimitives(k, q, DefaultQueryContext(), stats);
+	}
+
+	//closest k primitive computation using the scratch memory of the given context
+	template <typename Stats>
+	std::vector<ResultEntry> ClosestKPrimitives(size_t k, const Eigen::Vector3f& q, QueryContext& context, Stats& stats) const
+	{
+		assert(IsCompleted());
+		stats.CountQuery();
+		if (root == nullptr || k == 0)
+			return std::vector<ResultEntry>();
+
+		//max heap holding the k closest primitives found so far
+		std::vector<ResultEntry>& kBest = context.resultHeap;
+		kBest.clear();
+
+		std::vector<SearchEntry>& heap = context.nodeHeap;
+		heap.clear();
+		PushNode(heap, root, q, stats);
+
+		while (!heap.empty())
+		{
+			SearchEntry current = PopNode(heap, stats);
+
+			// If we already have k primitives which are all closer than the closest box, we can stop
+			if (kBest.size() == k && current.sqrDistance >= kBest.front().sqrDistance)
+				break;
+
+			if (current.node->IsLeaf())
+			{
+				stats.CountLeaf();
+				const AABBLeafNode* leaf = static_cast<const AABBLeafNode*>(current.node);
+				for (auto it = leaf->begin(); it != leaf->end(); ++it)
+				{
+					stats.CountPrimitiveTest();
+					float dist = it->SqrDistance(q);
+					if (kBest.size() < k)
+					{
+						kBest.emplace_back(dist, &(*it));
+						std::push_heap(kBest.begin(), kBest.end());
+					}
+					else if (dist < kBest.front().sqrDistance)
+					{
+						std::pop_heap(kBest.begin(), kBest.end());
+						kBest.back() = ResultEntry(dist, &(*it));
+						std::push_heap(kBest.begin(), kBest.end());
+					}
+				}
+			}
+			else
+			{
+				const AABBSplitNode* split = static_cast<const AABBSplitNode*>(current.node);
+				PushNode(heap, split->Left(), q, stats);
+				PushNode(heap, split->Right(), q, stats);
+			}
+		}
+
+		std::sort_heap(kBest.begin(), kBest.end());
+		return std::vector<ResultEntry>(kBest.begin(), kBest.end());
 	}
 	
 
 	// Returns the closest primitive and its squared distance to the point q
 	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q) const
+	{
+		NoQueryStats stats;
+		return ClosestPrimitive(q, DefaultQueryContext(), stats);
+	}
+
+	// Returns the closest primitive and its squared distance to the point q and records the work in stats (see QueryStats)
+	template <typename Stats>
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q, Stats& stats) const
+	{
+		return ClosestPrimitive(q, DefaultQueryContext(), stats);
+	}
+
+	// Returns the closest primitive and its squared distance to the point q
+	// best-first search over the nodes, which uses the priority queue of the given context
+	template <typename Stats>
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q, QueryContext& context, Stats& stats) const
 	{
 		assert(IsCompleted());
+		stats.CountQuery();
 		if (root == nullptr)
 			return ResultEntry();
 
-		std::priority_queue<SearchEntry> pq;
-		pq.emplace(root->GetBounds().SqrDistance(q), root);
+		std::vector<SearchEntry>& heap = context.nodeHeap;
+		heap.clear();
+		PushNode(heap, root, q, stats);
 
 		ResultEntry best;
 
-		while (!pq.empty())
+		while (!heap.empty())
 		{
 			// Get the node with the closest bounding box
-			SearchEntry current = pq.top();
-			pq.pop();
+			SearchEntry current = PopNode(heap, stats);
 
 			// If the best distance is already smaller than the closest box, we can stop
 			if (current.sqrDistance >= best.sqrDistance)
@@ -416,27 +537,70 @@ public:
 
 			// If the node is a leaf, check all its primitives
 			if (current.node->IsLeaf())
+				TestLeaf(static_cast<const AABBLeafNode*>(current.node), q, best, stats);
+			else
 			{
-				const AABBLeafNode* leaf = static_cast<const AABBLeafNode*>(current.node);
-				for (auto it = leaf->begin(); it != leaf->end(); ++it)
+				// If the node is a split node, push both children into the priority queue
+				const AABBSplitNode* split = static_cast<const AABBSplitNode*>(current.node);
+				PushNode(heap, split->Left(), q, stats);
+				PushNode(heap, split->Right(), q, stats);
+			}
+		}
+
+		return best;
+	}
+
+	// Returns the closest primitive and its squared distance to the point q
+	// depth-first search which always descends into the nearer child first and defers the farther one
+	// on a small fixed-size stack (at most one entry per tree level), it does not use any heap memory
+	ResultEntry ClosestPrimitiveDepthFirst(const Eigen::Vector3f& q) const
+	{
+		NoQueryStats stats;
+		return ClosestPrimitiveDepthFirst(q, stats);
+	}
+
+	// depth-first closest primitive query which records its work in stats (see QueryStats)
+	template <typename Stats>
+	ResultEntry ClosestPrimitiveDepthFirst(const Eigen::Vector3f& q, Stats& stats) const
+	{
+		assert(IsCompleted());
+		stats.CountQuery();
+		ResultEntry best;
+		if (root == nullptr)
+			return best;
+
+		SearchEntry stack[MaxTraversalDepth];
+		int stackSize = 0;
+
+		SearchEntry current(root->GetBounds().SqrDistance(q), root);
+		stats.CountNode();
+		while (true)
+		{
+			if (current.sqrDistance < best.sqrDistance)
+			{
+				if (current.node->IsLeaf())
+					TestLeaf(static_cast<const AABBLeafNode*>(current.node), q, best, stats);
+				else
 				{
-					float dist = it->SqrDistance(q);
-					if (dist < best.sqrDistance)
+					const AABBSplitNode* split = static_cast<const AABBSplitNode*>(current.node);
+					SearchEntry nearChild = MakeEntry(split->Left(), q, stats);
+					SearchEntry farChild = MakeEntry(split->Right(), q, stats);
+					if (farChild.sqrDistance < nearChild.sqrDistance)
+						std::swap(nearChild, farChild);
+					if (farChild.sqrDistance < best.sqrDistance)
 					{
-						best.sqrDistance = dist;
-						best.prim = &(*it);
+						assert(stackSize < MaxTraversalDepth);
+						stack[stackSize++] = farChild;
+						stats.CountPush();
 					}
+					current = nearChild;
+					continue;
 				}
 			}
-			else
-			{
-				// If the node is a split node, push both children into the priority queue
-				const AABBSplitNode* split = static_cast<const AABBSplitNode*>(current.node);
-				if (split->Left())
-					pq.emplace(split->Left()->GetBounds().SqrDistance(q), split->Left());
-				if (split->Right())
-					pq.emplace(split->Right()->GetBounds().SqrDistance(q), split->Right());
-			}
+			if (stackSize == 0)
+				break;
+			current = stack[--stackSize];
+			stats.CountPop();
 		}
 
 		return best;
@@ -446,7 +610,15 @@ public:
 	//return the closest point position on the closest primitive in the tree with respect to the query point q
 	Eigen::Vector3f ClosestPoint(const Eigen::Vector3f& p) const
 	{
-		ResultEntry r = ClosestPrimitive(p);
+		NoQueryStats stats;
+		return ClosestPoint(p, stats);
+	}
+
+	//return the closest point position on the closest primitive in the tree and records the work in stats
+	template <typename Stats>
+	Eigen::Vector3f ClosestPoint(const Eigen::Vector3f& p, Stats& stats) const
+	{
+		ResultEntry r = ClosestPrimitive(p, stats);
 		return  r.prim->ClosestPoint(p);
 	}
 	
@@ -454,7 +626,7 @@ public:
 	float SqrDistance(const Eigen::Vector3f& p) const
 	{
 		ResultEntry r = ClosestPrimitive(p);
-		return r.SqrDistance;
+		return r.sqrDistance;
 	}
 
 	//return the euclidean distance between point p and the nearest primitive in the tree
@@ -463,9 +635,100 @@ public:
 		return sqrt(SqrDistance(p));
 	}
 
+	//collects structure statistics of the constructed tree (node counts, leaf depth and leaf size histograms)
+	TreeBuildStats ComputeBuildStats() const
+	{
+		assert(IsCompleted());
+		TreeBuildStats stats;
+		if (root != nullptr)
+			CollectBuildStats(root, 0, stats);
+		return stats;
+	}
+
+	//returns the number of bytes used by the nodes and the primitives of the tree (without allocation overhead)
+	size_t MemoryUsage() const
+	{
+		TreeBuildStats stats = ComputeBuildStats();
+		return sizeof(*this) + stats.numLeaves * sizeof(AABBLeafNode) + (stats.numNodes - stats.numLeaves) * sizeof(AABBSplitNode)
+			+ primitives.capacity() * sizeof(Primitive);
+	}
+
 
 protected:
 
+	//helper function to create a search entry for the node with its squared distance to q
+	//a missing child gets an infinite distance
+	template <typename Stats>
+	static SearchEntry MakeEntry(const AABBNode* node, const Eigen::Vector3f& q, Stats& stats)
+	{
+		if (node == nullptr)
+			return SearchEntry();
+		stats.CountNode();
+		return SearchEntry(node->GetBounds().SqrDistance(q), node);
+	}
+
+	//helper function to push a node with its squared distance to q into the priority queue of a query
+	template <typename Stats>
+	static void PushNode(std::vector<SearchEntry>& heap, const AABBNode* node, const Eigen::Vector3f& q, Stats& stats)
+	{
+		if (node == nullptr)
+			return;
+		heap.push_back(MakeEntry(node, q, stats));
+		std::push_heap(heap.begin(), heap.end());
+		stats.CountPush();
+	}
+
+	//helper function to remove and return the closest node from the priority queue of a query
+	template <typename Stats>
+	static SearchEntry PopNode(std::vector<SearchEntry>& heap, Stats& stats)
+	{
+		std::pop_heap(heap.begin(), heap.end());
+		SearchEntry entry = heap.back();
+		heap.pop_back();
+		stats.CountPop();
+		return entry;
+	}
+
+	//helper function to test all primitives of a leaf against the current best result of a query
+	template <typename Stats>
+	static void TestLeaf(const AABBLeafNode* leaf, const Eigen::Vector3f& q, ResultEntry& best, Stats& stats)
+	{
+		stats.CountLeaf();
+		for (auto it = leaf->begin(); it != leaf->end(); ++it)
+		{
+			stats.CountPrimitiveTest();
+			float dist = it->SqrDistance(q);
+			if (dist < best.sqrDistance)
+			{
+				best.sqrDistance = dist;
+				best.prim = &(*it);
+			}
+		}
+	}
+
+	//helper function to accumulate the build statistics of a subtree
+	void CollectBuildStats(const AABBNode* node, int depth, TreeBuildStats& stats) const
+	{
+		++stats.numNodes;
+		if (node->IsLeaf())
+		{
+			int n = node->NumPrimitives();
+			++stats.numLeaves;
+			stats.numPrimitives += n;
+			stats.maxDepth = std::max(stats.maxDepth, depth);
+			++stats.depthHistogram[depth];
+			++stats.leafSizeHistogram[n];
+		}
+		else
+		{
+			const AABBSplitNode* split = static_cast<const AABBSplitNode*>(node);
+			if (split->Left() != nullptr)
+				CollectBuildStats(split->Left(), depth + 1, stats);
+			if (split->Right() != nullptr)
+				CollectBuildStats(split->Right(), depth + 1, stats);
+		}
+	}
+
 	//helper function to copy a subtree
 	AABBNode* CopyTree(const primitive_list& other_primitives,AABBNode* node)
 	{
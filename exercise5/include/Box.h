@@ -78,4 +78,8 @@ public:
 	//returns the euclidean distance between p and the box 
 	float Distance(const Eigen::Vector3f& p) const;
 
+	//computes the parameter interval [tEnter,tExit] of the ray origin + t * dir (t >= 0) inside the box
+	//returns false if the ray misses the box
+	bool IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float& tEnter, float& tExit) const;
+
 };
@@ -0,0 +1,391 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+#include "AABBTree.h"
+
+/**
+* Read-only, memory compact version of an AABBTree for very large meshes.
+* The nodes are stored in a single array. Each node stores the bounds of its two children quantized
+* to Quantized (std::uint8_t or std::uint16_t) relative to its own bounds and 32-bit references to them.
+* Only the bounds of the root are stored as floats; the bounds of all other nodes are decoded during the traversal.
+* The quantized bounds are rounded outwards, the decoded box of a node always contains the exact box,
+* such that queries can only visit more nodes but never miss a primitive.
+* The tree can be compressed from a completed AABBTree or built directly from the primitives. The direct build
+* never holds the uncompressed nodes and a second copy of the primitives, which lowers the peak memory.
+*/
+template <typename Primitive, typename Quantized = std::uint8_t>
+class CompressedAABBTree
+{
+public:
+	//result entry of closest primitive queries
+	struct ResultEntry
+	{
+		//squared distance from query point to primitive
+		float sqrDistance;
+		//pointer to primitive
+		const Primitive* prim;
+		//default constructor
+		ResultEntry()
+			: sqrDistance(std::numeric_limits<float>::infinity()), prim(nullptr)
+		{ }
+	};
+
+	//creates an empty tree
+	CompressedAABBTree()
+		: rootRef(EmptyRef)
+	{ }
+
+	//creates the compressed version of the given completed tree
+	explicit CompressedAABBTree(const AABBTree<Primitive>& tree)
+	{
+		Build(tree);
+	}
+
+	//creates the tree directly from the given primitives, see Build
+	explicit CompressedAABBTree(std::vector<Primitive> primitives, int maxDepth = 20, int minSize = 2)
+	{
+		Build(std::move(primitives), maxDepth, minSize);
+	}
+
+	//replaces the content of this tree with the compressed version of the given completed tree
+	void Build(const AABBTree<Primitive>& tree)
+	{
+		nodes.clear();
+		leaves.clear();
+		primitives.clear();
+		rootRef = EmptyRef;
+		const typename AABBTree<Primitive>::AABBNode* root = tree.Root();
+		if (root != nullptr)
+		{
+			rootBounds = root->GetBounds();
+			rootRef = Encode(root, rootBounds);
+		}
+		nodes.shrink_to_fit();
+		leaves.shrink_to_fit();
+		primitives.shrink_to_fit();
+	}
+
+	//replaces the content of this tree with a tree over the given primitives, which are reordered in place
+	//the splits are the same as in AABBTree(maxDepth, minSize), so the result equals the compressed version of
+	//such a tree, but no uncompressed nodes are created; move the primitives in to avoid a copy
+	void Build(std::vector<Primitive> prims, int maxDepth = 20, int minSize = 2)
+	{
+		nodes.clear();
+		leaves.clear();
+		primitives = std::move(prims);
+		rootRef = EmptyRef;
+		assert(primitives.size() <= std::numeric_limits<std::uint32_t>::max());
+		maxDepth = std::min(maxDepth, AABBTree<Primitive>::MaxTraversalDepth - 1);
+		if (!primitives.empty())
+		{
+			rootBounds = ComputeBounds(0, primitives.size());
+			rootRef = EncodeRange(0, primitives.size(), rootBounds, rootBounds, 0, maxDepth, minSize);
+		}
+		nodes.shrink_to_fit();
+		leaves.shrink_to_fit();
+		primitives.shrink_to_fit();
+	}
+
+	//returns the number of bytes used by the tree including its primitives
+	size_t MemoryUsage() const
+	{
+		return sizeof(*this) + nodes.capacity() * sizeof(Node) + leaves.capacity() * sizeof(Leaf) + primitives.capacity() * sizeof(Primitive);
+	}
+
+	//returns the number of split nodes
+	size_t NumNodes() const { return nodes.size(); }
+
+	//returns the number of leaves
+	size_t NumLeaves() const { return leaves.size(); }
+
+	// Returns the closest primitive and its squared distance to the point q
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q) const
+	{
+		NoQueryStats stats;
+		return ClosestPrimitive(q, stats);
+	}
+
+	// Returns the closest primitive and its squared distance to the point q and records the work in stats (see QueryStats)
+	// depth-first search which always descends into the nearer child first, like AABBTree::ClosestPrimitiveDepthFirst
+	template <typename Stats>
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q, Stats& stats) const
+	{
+		stats.CountQuery();
+		ResultEntry best;
+		if (rootRef == EmptyRef)
+			return best;
+
+		StackEntry stack[AABBTree<Primitive>::MaxTraversalDepth];
+		int stackSize = 0;
+
+		StackEntry current(rootBounds.SqrDistance(q), rootRef, rootBounds);
+		stats.CountNode();
+		while (true)
+		{
+			if (current.sqrDistance < best.sqrDistance)
+			{
+				if (current.ref & LeafFlag)
+				{
+					stats.CountLeaf();
+					const Leaf& leaf = leaves[current.ref & ~LeafFlag];
+					auto end = primitives.begin() + leaf.begin + leaf.count;
+					for (auto it = primitives.begin() + leaf.begin; it != end; ++it)
+					{
+						stats.CountPrimitiveTest();
+						float dist = it->SqrDistance(q);
+						if (dist < best.sqrDistance)
+						{
+							best.sqrDistance = dist;
+							best.prim = &(*it);
+						}
+					}
+				}
+				else
+				{
+					const Node& node = nodes[current.ref];
+					StackEntry nearChild = MakeEntry(node, 0, current.bounds, q, stats);
+					StackEntry farChild = MakeEntry(node, 1, current.bounds, q, stats);
+					if (farChild.sqrDistance < nearChild.sqrDistance)
+						std::swap(nearChild, farChild);
+					if (farChild.sqrDistance < best.sqrDistance)
+					{
+						assert(stackSize < AABBTree<Primitive>::MaxTraversalDepth);
+						stack[stackSize++] = farChild;
+						stats.CountPush();
+					}
+					current = nearChild;
+					continue;
+				}
+			}
+			if (stackSize == 0)
+				break;
+			current = stack[--stackSize];
+			stats.CountPop();
+		}
+
+		return best;
+	}
+
+	//return the closest point position on the closest primitive in the tree with respect to the query point p
+	Eigen::Vector3f ClosestPoint(const Eigen::Vector3f& p) const
+	{
+		ResultEntry r = ClosestPrimitive(p);
+		return r.prim->ClosestPoint(p);
+	}
+
+private:
+	//references with this flag set are leaf indices, all others are node indices
+	static const std::uint32_t LeafFlag = 0x80000000u;
+	//reference of a missing child
+	static const std::uint32_t EmptyRef = 0xFFFFFFFFu;
+	//largest quantized coordinate, it corresponds to the upper bound of the parent
+	static const std::uint32_t QuantizationSteps = std::numeric_limits<Quantized>::max();
+
+	//split node with the quantized bounds of both children
+	struct Node
+	{
+		//quantized lower and upper bounds of the children relative to the bounds of this node
+		Quantized childMin[2][3];
+		Quantized childMax[2][3];
+		//references to the children
+		std::uint32_t children[2];
+	};
+
+	//leaf with a range of primitives
+	struct Leaf
+	{
+		std::uint32_t begin;
+		std::uint32_t count;
+	};
+
+	//deferred node of the traversal with its decoded bounds
+	struct StackEntry
+	{
+		float sqrDistance;
+		std::uint32_t ref;
+		Box bounds;
+
+		StackEntry()
+			: sqrDistance(std::numeric_limits<float>::infinity()), ref(EmptyRef)
+		{ }
+
+		StackEntry(float sqrDistance, std::uint32_t ref, const Box& bounds)
+			: sqrDistance(sqrDistance), ref(ref), bounds(bounds)
+		{ }
+	};
+
+	//maps a quantized coordinate back to the interval [lower, upper]
+	//the ends of the interval are reproduced exactly, the build uses this function to check that the
+	//chosen codes enclose the exact bounds
+	static float Dequantize(float lower, float upper, std::uint32_t code)
+	{
+		if (code == 0)
+			return lower;
+		if (code >= QuantizationSteps)
+			return upper;
+		return lower + (upper - lower) * ((float)code / QuantizationSteps);
+	}
+
+	//returns the largest code whose decoded value is not above value
+	static Quantized QuantizeLower(float lower, float upper, float value)
+	{
+		float t = upper > lower ? (value - lower) / (upper - lower) : 0.0f;
+		std::int64_t code = (std::int64_t)std::floor(t * QuantizationSteps);
+		code = std::max<std::int64_t>(0, std::min<std::int64_t>((std::int64_t)QuantizationSteps, code));
+		while (code > 0 && Dequantize(lower, upper, (std::uint32_t)code) > value)
+			--code;
+		return (Quantized)code;
+	}
+
+	//returns the smallest code whose decoded value is not below value
+	static Quantized QuantizeUpper(float lower, float upper, float value)
+	{
+		float t = upper > lower ? (value - lower) / (upper - lower) : 1.0f;
+		std::int64_t code = (std::int64_t)std::ceil(t * QuantizationSteps);
+		code = std::max<std::int64_t>(0, std::min<std::int64_t>((std::int64_t)QuantizationSteps, code));
+		while (code < QuantizationSteps && Dequantize(lower, upper, (std::uint32_t)code) < value)
+			++code;
+		return (Quantized)code;
+	}
+
+	//decodes the bounds of child i of the node with the given (decoded) bounds
+	static Box DecodeChildBounds(const Node& node, int i, const Box& parent)
+	{
+		Box b;
+		for (int d = 0; d < 3; ++d)
+		{
+			b.LowerBound()[d] = Dequantize(parent.LowerBound()[d], parent.UpperBound()[d], node.childMin[i][d]);
+			b.UpperBound()[d] = Dequantize(parent.LowerBound()[d], parent.UpperBound()[d], node.childMax[i][d]);
+		}
+		return b;
+	}
+
+	//creates the traversal entry of child i, a missing child gets an infinite distance
+	template <typename Stats>
+	static StackEntry MakeEntry(const Node& node, int i, const Box& parent, const Eigen::Vector3f& q, Stats& stats)
+	{
+		if (node.children[i] == EmptyRef)
+			return StackEntry();
+		stats.CountNode();
+		Box b = DecodeChildBounds(node, i, parent);
+		return StackEntry(b.SqrDistance(q), node.children[i], b);
+	}
+
+	//recursively appends the subtree of node whose decoded bounds are given and returns its reference
+	std::uint32_t Encode(const typename AABBTree<Primitive>::AABBNode* node, const Box& bounds)
+	{
+		if (node->IsLeaf())
+		{
+			auto leafNode = static_cast<const typename AABBTree<Primitive>::AABBLeafNode*>(node);
+			assert(leaves.size() < LeafFlag && primitives.size() + leafNode->NumPrimitives() <= std::numeric_limits<std::uint32_t>::max());
+			Leaf leaf;
+			leaf.begin = (std::uint32_t)primitives.size();
+			leaf.count = (std::uint32_t)leafNode->NumPrimitives();
+			primitives.insert(primitives.end(), leafNode->begin(), leafNode->end());
+			leaves.push_back(leaf);
+			return LeafFlag | (std::uint32_t)(leaves.size() - 1);
+		}
+
+		auto split = static_cast<const typename AABBTree<Primitive>::AABBSplitNode*>(node);
+		assert(nodes.size() < LeafFlag);
+		std::uint32_t index = (std::uint32_t)nodes.size();
+		nodes.emplace_back();
+		const typename AABBTree<Primitive>::AABBNode* children[2] = { split->Left(), split->Right() };
+		for (int i = 0; i < 2; ++i)
+		{
+			Node& n = nodes[index];
+			if (children[i] == nullptr)
+			{
+				std::fill(n.childMin[i], n.childMin[i] + 3, (Quantized)0);
+				std::fill(n.childMax[i], n.childMax[i] + 3, (Quantized)0);
+				n.children[i] = EmptyRef;
+				continue;
+			}
+			Box decoded = QuantizeChildBounds(n, i, bounds, children[i]->GetBounds());
+			std::uint32_t ref = Encode(children[i], decoded);
+			nodes[index].children[i] = ref;
+		}
+		return index;
+	}
+
+	//stores the bounds of child i of node n quantized relative to the decoded bounds of n and returns the decoded child bounds
+	//the children are quantized relative to the decoded bounds, which the traversal reproduces exactly
+	static Box QuantizeChildBounds(Node& n, int i, const Box& bounds, const Box& childBounds)
+	{
+		for (int d = 0; d < 3; ++d)
+		{
+			n.childMin[i][d] = QuantizeLower(bounds.LowerBound()[d], bounds.UpperBound()[d], childBounds.LowerBound()[d]);
+			n.childMax[i][d] = QuantizeUpper(bounds.LowerBound()[d], bounds.UpperBound()[d], childBounds.UpperBound()[d]);
+		}
+		return DecodeChildBounds(n, i, bounds);
+	}
+
+	//bounding box of the primitives [begin, end)
+	Box ComputeBounds(size_t begin, size_t end) const
+	{
+		Box bounds;
+		for (size_t i = begin; i < end; ++i)
+			bounds.Insert(primitives[i].ComputeBounds());
+		return bounds;
+	}
+
+	//recursively appends the subtree of the primitives [begin, end) and returns its reference
+	//bounds are the exact bounds of the range, decoded the bounds that the traversal decodes for it
+	//the splits follow AABBTree::Build: median of the reference points along the largest extent
+	std::uint32_t EncodeRange(size_t begin, size_t end, const Box& bounds, const Box& decoded, int depth, int maxDepth, int minSize)
+	{
+		if (depth >= maxDepth || end - begin <= (size_t)minSize)
+		{
+			assert(leaves.size() < LeafFlag);
+			Leaf leaf;
+			leaf.begin = (std::uint32_t)begin;
+			leaf.count = (std::uint32_t)(end - begin);
+			leaves.push_back(leaf);
+			return LeafFlag | (std::uint32_t)(leaves.size() - 1);
+		}
+
+		Eigen::Vector3f e = bounds.Extents();
+		int axis = 0;
+		if (e[0] < e[1])
+			axis = 1;
+		if (e[axis] < e[2])
+			axis = 2;
+		size_t mid = begin + (end - begin) / 2;
+		std::nth_element(primitives.begin() + begin, primitives.begin() + mid, primitives.begin() + end, [axis](const Primitive& a, const Primitive& b)
+			{ return a.ReferencePoint()[axis] < b.ReferencePoint()[axis]; });
+
+		assert(nodes.size() < LeafFlag);
+		std::uint32_t index = (std::uint32_t)nodes.size();
+		nodes.emplace_back();
+		const size_t ranges[2][2] = { { begin, mid }, { mid, end } };
+		for (int i = 0; i < 2; ++i)
+		{
+			Box childBounds = ComputeBounds(ranges[i][0], ranges[i][1]);
+			Box childDecoded = QuantizeChildBounds(nodes[index], i, decoded, childBounds);
+			std::uint32_t ref = EncodeRange(ranges[i][0], ranges[i][1], childBounds, childDecoded, depth + 1, maxDepth, minSize);
+			nodes[index].children[i] = ref;
+		}
+		return index;
+	}
+
+	//split nodes in depth-first order
+	std::vector<Node> nodes;
+	//leaves in depth-first order
+	std::vector<Leaf> leaves;
+	//copies of the primitives, ordered such that each leaf references a contiguous range
+	std::vector<Primitive> primitives;
+	//exact bounds of the root node
+	Box rootBounds;
+	//reference to the root node, a leaf or EmptyRef
+	std::uint32_t rootRef;
+};
@@ -7,11 +7,15 @@
 #include <unordered_map>
 #include <array>
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
 #include "Box.h"
 #include "GridUtils.h"
 #include "Triangle.h"
 #include "Point.h"
 #include "LineSegment.h"
+#include "QueryStats.h"
 
 template <typename Primitive >
 class HashGrid 
@@ -31,6 +35,19 @@ public:
 	};
 	//type of internal hash map
 	typedef std::unordered_map<Eigen::Vector3i,std::vector<Primitive>,GridHashFunc> CellHashMapType;	
+
+	//result entry for closest primitive queries
+	struct ResultEntry
+	{
+		//squared distance from query point to primitive
+		float sqrDistance;
+		//pointer to primitive
+		const Primitive* prim;
+		//default constructor
+		ResultEntry()
+			: sqrDistance(std::numeric_limits<float>::infinity()), prim(nullptr)
+		{ }
+	};
 	
 private:
 	//internal hash map storing the data of each non empty grid cell
@@ -38,6 +55,10 @@ private:
 	CellHashMapType cellHashMap;
 	//internal extents of a cell
 	Eigen::Vector3f cellExtents;
+	//smallest and largest index of all non empty cells in each dimension, used to bound the closest primitive search
+	Eigen::Vector3i minCellIndex, maxCellIndex;
+	//number of primitives inserted into the grid
+	size_t numPrimitives;
 
 public:
 	//constructor for hash grid with uniform cell extent
@@ -45,12 +66,14 @@ public:
 	HashGrid(const float cellExtent=0.01,const int initialSize=1): cellHashMap(initialSize)
 	{		
 		cellExtents[0] =cellExtents[1] =cellExtents[2] = cellExtent;
+		ResetCellIndexBounds();
 	}
 
 	//constructor for  hash grid with non uniform cell extents
 	//initial size is used to preallocate memory for the internal unordered map
 	HashGrid(const Eigen::Vector3f& cellExtents,const int initialSize): cellHashMap(initialSize),cellExtents(cellExtents)
 	{	
+		ResetCellIndexBounds();
 	}
 
 	//resize hash map with at least count buckets
@@ -169,7 +192,9 @@ public:
 		Eigen::Vector3i lb_idx = PositionToIndex(lb);
 		Eigen::Vector3i ub_idx = PositionToIndex(ub);
 
-		
+		++numPrimitives;
+		minCellIndex = minCellIndex.cwiseMin(lb_idx);
+		maxCellIndex = maxCellIndex.cwiseMax(ub_idx);
 		
 		Eigen::Vector3i idx;
 		for(idx[0] = lb_idx[0]; idx[0] <=ub_idx[0]; ++idx[0])
@@ -185,6 +210,71 @@ public:
 	void Clear()
 	{
 		cellHashMap.clear();
+		ResetCellIndexBounds();
+	}
+
+	//returns the closest primitive and its squared distance to the point q
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q) const
+	{
+		NoQueryStats stats;
+		return ClosestPrimitive(q, stats);
+	}
+
+	//returns the closest primitive and its squared distance to the point q and records the work in stats (see QueryStats)
+	//the cells are visited in rings of growing size around the cell containing q until no closer primitive can be found
+	template <typename Stats>
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q, Stats& stats) const
+	{
+		stats.CountQuery();
+		ResultEntry best;
+		if (cellHashMap.empty())
+			return best;
+
+		Eigen::Vector3i center = PositionToIndex(q);
+		//rings before minRing do not reach the non empty cells, beyond maxRing there are no more non empty cells
+		int minRing = 0, maxRing = 0;
+		for (int d = 0; d < 3; ++d)
+		{
+			minRing = std::max(minRing, std::max(minCellIndex[d] - center[d], center[d] - maxCellIndex[d]));
+			maxRing = std::max(maxRing, std::max(center[d] - minCellIndex[d], maxCellIndex[d] - center[d]));
+		}
+		const float minExtent = cellExtents.minCoeff();
+
+		for (int r = minRing; r <= maxRing; ++r)
+		{
+			//all cells of ring r are at least r-1 cells away from q
+			float ringDistance = (r - 1) * minExtent;
+			if (r > 0 && ringDistance > 0 && ringDistance * ringDistance >= best.sqrDistance)
+				break;
+
+			Eigen::Vector3i idx;
+			int xBegin = std::max(center[0] - r, minCellIndex[0]), xEnd = std::min(center[0] + r, maxCellIndex[0]);
+			int yBegin = std::max(center[1] - r, minCellIndex[1]), yEnd = std::min(center[1] + r, maxCellIndex[1]);
+			for (idx[0] = xBegin; idx[0] <= xEnd; ++idx[0])
+				for (idx[1] = yBegin; idx[1] <= yEnd; ++idx[1])
+				{
+					//inside the x and y faces of the ring only the two z faces belong to it
+					bool onRingSide = std::abs(idx[0] - center[0]) == r || std::abs(idx[1] - center[1]) == r;
+					int zStep = onRingSide ? 1 : 2 * r;
+					for (idx[2] = center[2] - r; idx[2] <= center[2] + r; idx[2] += zStep)
+						VisitCell(idx, q, best, stats);
+				}
+		}
+		return best;
+	}
+
+	//collects occupancy statistics of the grid (number of cells, duplication of primitives and occupancy histogram)
+	GridBuildStats ComputeBuildStats() const
+	{
+		GridBuildStats stats;
+		stats.numCells = cellHashMap.size();
+		stats.numPrimitives = numPrimitives;
+		for (auto& cell : cellHashMap)
+		{
+			stats.numReferences += cell.second.size();
+			++stats.occupancyHistogram[cell.second.size()];
+		}
+		return stats;
 	}
 	
 	//returns true if hashgrid contains no cells
@@ -250,6 +340,41 @@ public:
 		assert(!Empty(idx));
 		return cellHashMap[idx].cend();
 	}
+
+private:
+	//resets the bounds of the non empty cells and the primitive counter to an empty grid
+	void ResetCellIndexBounds()
+	{
+		minCellIndex.setConstant(std::numeric_limits<int>::max());
+		maxCellIndex.setConstant(std::numeric_limits<int>::lowest());
+		numPrimitives = 0;
+	}
+
+	//tests the primitives of cell idx against the current best result of a closest primitive query
+	template <typename Stats>
+	void VisitCell(const Eigen::Vector3i& idx, const Eigen::Vector3f& q, ResultEntry& best, Stats& stats) const
+	{
+		for (int d = 0; d < 3; ++d)
+			if (idx[d] < minCellIndex[d] || idx[d] > maxCellIndex[d])
+				return;
+		stats.CountNode();
+		if (CellBounds(idx).SqrDistance(q) >= best.sqrDistance)
+			return;
+		auto it = cellHashMap.find(idx);
+		if (it == cellHashMap.end())
+			return;
+		stats.CountLeaf();
+		for (auto& p : it->second)
+		{
+			stats.CountPrimitiveTest();
+			float dist = p.SqrDistance(q);
+			if (dist < best.sqrDistance)
+			{
+				best.sqrDistance = dist;
+				best.prim = &p;
+			}
+		}
+	}
 };
 
 //helper function to construct a hashgrid data structure from the triangle faces of the halfedge mesh m
@@ -0,0 +1,239 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <ostream>
+
+#include <util/MappedFile.h>
+#include "AABBTree.h"
+#include "Triangle.h"
+#include "QueryStats.h"
+
+/*
+Out-of-core closest point and ray queries on triangle meshes which do not fit into memory.
+
+The triangles are grouped into spatially coherent chunks. Every chunk is stored in its own file
+as a flat AABB tree (nodes followed by the triangles in leaf order), which is memory-mapped
+when a query reaches the chunk. A small in-memory AABBTree over the chunk bounds (the top tree)
+decides which chunks a query has to visit. Mapped chunks are kept in a least recently used list and
+unmapped once the mapped bytes exceed the memory budget.
+
+Files of a tree with the base path P: P.index and P.chunk0, P.chunk1, ...
+*/
+
+//I/O counters of an OutOfCoreAABBTree
+struct OutOfCoreIOStats
+{
+	//number of chunk accesses which found the chunk already mapped
+	size_t chunkHits = 0;
+	//number of chunks mapped from disk
+	size_t chunkLoads = 0;
+	//number of chunks unmapped to stay within the memory budget
+	size_t chunkEvictions = 0;
+	//total number of bytes mapped from disk
+	size_t bytesLoaded = 0;
+	//number of currently mapped bytes
+	size_t residentBytes = 0;
+	//maximum number of mapped bytes
+	size_t peakResidentBytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const OutOfCoreIOStats& stats);
+
+/*
+writes the chunk files of an out-of-core tree from a stream of triangles
+the triangles are binned on a regular grid over the given bounds by their centroids and spilled to temporary
+files next to the base path, grid cells with more than maxChunkTriangles triangles are split recursively
+only the binning buffers and a single chunk are held in memory at any time
+*/
+class OutOfCoreAABBTreeBuilder
+{
+public:
+	//expectedTriangles is used to choose the resolution of the initial grid
+	OutOfCoreAABBTreeBuilder(const std::string& basePath, const Box& bounds, size_t expectedTriangles, size_t maxChunkTriangles = 1 << 16);
+
+	//removes remaining temporary files
+	~OutOfCoreAABBTreeBuilder();
+
+	//adds a triangle, the triangle will report faceId as its face
+	void AddTriangle(const Eigen::Vector3f& v0, const Eigen::Vector3f& v1, const Eigen::Vector3f& v2, int faceId);
+
+	//builds and writes all chunks and the index file
+	//returns false if a file could not be written
+	bool Finish();
+
+	//triangle record of the temporary and the chunk files
+	struct StoredTriangle
+	{
+		float v[3][3];
+		int32_t face;
+	};
+
+	//entry of the index file
+	struct ChunkInfo
+	{
+		float lowerBound[3];
+		float upperBound[3];
+		uint32_t numTriangles;
+		uint32_t reserved;
+		uint64_t fileSize;
+	};
+
+private:
+	std::string BinPath(size_t bin) const;
+	bool FlushBins();
+	bool ProcessBin(const std::string& path, size_t count, const Box& cell, int depth);
+	bool WriteChunk(std::vector<StoredTriangle>& triangles);
+
+	std::string basePath;
+	Box bounds;
+	size_t maxChunkTriangles;
+	int resolution;
+	std::vector<std::vector<StoredTriangle>> bins;
+	std::vector<size_t> binCounts;
+	size_t bufferedTriangles;
+	size_t numTemporaryFiles;
+	size_t numTriangles;
+	std::vector<ChunkInfo> chunks;
+	bool failed;
+};
+
+//writes an out-of-core tree for the triangle faces of the halfedge mesh m
+bool BuildOutOfCoreAABBTree(const HEMesh& m, const std::string& basePath, size_t maxChunkTriangles = 1 << 16);
+
+//writes an out-of-core tree for the triangles of a binary STL file without loading the whole file
+//the face index of a triangle is its position in the file
+bool BuildOutOfCoreAABBTreeFromSTL(const std::string& stlPath, const std::string& basePath, size_t maxChunkTriangles = 1 << 16);
+
+/*
+query side of the out-of-core tree
+queries map chunks on demand and update the cache, therefore they are not const and an instance must not be shared by several threads
+*/
+class OutOfCoreAABBTree
+{
+public:
+	//result entry of closest point queries
+	struct ResultEntry
+	{
+		//squared distance from query point to the closest triangle
+		float sqrDistance;
+		//closest point on the closest triangle
+		Eigen::Vector3f closestPoint;
+		//face of the closest triangle
+		OpenMesh::FaceHandle face;
+
+		ResultEntry();
+	};
+
+	//result entry of ray queries
+	struct RayHit
+	{
+		//ray parameter of the first intersection, infinity if there is none
+		float t;
+		//intersected face
+		OpenMesh::FaceHandle face;
+
+		RayHit();
+		bool IsHit() const;
+	};
+
+	//memoryBudget is the maximum number of bytes of mapped chunks
+	OutOfCoreAABBTree(size_t memoryBudget = 256 << 20);
+
+	//opens the tree with the given base path, returns false if the index cannot be read
+	bool Open(const std::string& basePath);
+
+	//unmaps all chunks and releases the top tree
+	void Close();
+
+	bool IsOpen() const;
+
+	//changes the memory budget, unmaps chunks if necessary
+	void SetMemoryBudget(size_t bytes);
+
+	size_t NumChunks() const;
+	size_t NumTriangles() const;
+	//returns the total size of all chunk files in bytes
+	size_t DataSize() const;
+
+	//returns the closest triangle to q
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q);
+	//returns the closest triangle to q and records the work in stats (see QueryStats)
+	ResultEntry ClosestPrimitive(const Eigen::Vector3f& q, QueryStats& stats);
+
+	//return the closest point on the closest triangle to p
+	Eigen::Vector3f ClosestPoint(const Eigen::Vector3f& p);
+
+	//returns the first intersection of the ray origin + t * dir with 0 <= t < tMax
+	RayHit IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax = std::numeric_limits<float>::infinity());
+	//returns the first intersection of the ray and records the work in stats (see QueryStats)
+	RayHit IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax, QueryStats& stats);
+
+	//returns the I/O counters
+	const OutOfCoreIOStats& IOStats() const;
+
+	//sets the I/O counters to zero, except for the number of resident bytes
+	void ResetIOStats();
+
+	//deletes the files of the tree with the given base path
+	static void RemoveFiles(const std::string& basePath);
+
+	//primitive of the top tree, the bounds of a chunk
+	struct ChunkPrimitive
+	{
+		Box bounds;
+		uint32_t chunk;
+
+		Box ComputeBounds() const { return bounds; }
+		Eigen::Vector3f ReferencePoint() const { return bounds.Center(); }
+		float SqrDistance(const Eigen::Vector3f& p) const { return bounds.SqrDistance(p); }
+	};
+
+private:
+	struct Chunk
+	{
+		Box bounds;
+		uint32_t numTriangles;
+		uint64_t fileSize;
+		nse::util::MappedFile file;
+		//position in the lru list if the chunk is mapped
+		std::list<uint32_t>::iterator lruPosition;
+	};
+
+	//search entry of the top tree traversal
+	struct SearchEntry
+	{
+		float key;
+		const AABBTree<ChunkPrimitive>::AABBNode* node;
+
+		bool operator<(const SearchEntry& e) const { return key > e.key; }
+	};
+
+	template <typename Stats>
+	ResultEntry ClosestPrimitiveImpl(const Eigen::Vector3f& q, Stats& stats);
+	template <typename Stats>
+	RayHit IntersectRayImpl(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax, Stats& stats);
+
+	//maps the chunk if necessary and marks it as most recently used, returns the start of its data
+	const char* AcquireChunk(uint32_t chunk);
+	//unmaps least recently used chunks until additionalBytes fit into the budget
+	void EvictFor(size_t additionalBytes);
+
+	std::string basePath;
+	size_t memoryBudget;
+	size_t numTriangles;
+	std::vector<Chunk> chunks;
+	AABBTree<ChunkPrimitive> topTree;
+	//mapped chunks, most recently used first
+	std::list<uint32_t> lru;
+	OutOfCoreIOStats ioStats;
+	//priority queue of the top tree traversal, kept between queries
+	std::vector<SearchEntry> heap;
+	bool isOpen;
+};
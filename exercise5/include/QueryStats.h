@@ -0,0 +1,92 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+
+/*
+counters collected by the queries of the AABBTree and the HashGrid data structure
+pass an instance to a query to record what it did; several queries can be accumulated into one instance
+*/
+struct QueryStats
+{
+	//number of tree nodes (or grid cells) whose bounds were inspected
+	size_t nodesVisited = 0;
+	//number of leaf nodes (or non-empty grid cells) whose primitives were tested
+	size_t leavesVisited = 0;
+	//number of primitive distance computations
+	size_t primitiveTests = 0;
+	//number of entries pushed to the priority queue
+	size_t queuePushes = 0;
+	//number of entries popped from the priority queue
+	size_t queuePops = 0;
+	//number of queries accumulated in this instance
+	size_t queries = 0;
+
+	void CountQuery() { ++queries; }
+	void CountNode() { ++nodesVisited; }
+	void CountLeaf() { ++leavesVisited; }
+	void CountPrimitiveTest() { ++primitiveTests; }
+	void CountPush() { ++queuePushes; }
+	void CountPop() { ++queuePops; }
+
+	//sets all counters to zero
+	void Reset();
+
+	//accumulates the counters of another instance
+	QueryStats& operator+=(const QueryStats& other);
+};
+
+/*
+stats collector with the same interface as QueryStats which does nothing
+queries use it by default, so all counting code is removed by the compiler unless stats are requested
+*/
+struct NoQueryStats
+{
+	void CountQuery() { }
+	void CountNode() { }
+	void CountLeaf() { }
+	void CountPrimitiveTest() { }
+	void CountPush() { }
+	void CountPop() { }
+};
+
+//structure statistics of a constructed AABBTree
+struct TreeBuildStats
+{
+	size_t numNodes = 0;
+	size_t numLeaves = 0;
+	size_t numPrimitives = 0;
+	//depth of the deepest leaf
+	int maxDepth = 0;
+	//maps leaf depth to the number of leaves at this depth
+	std::map<int, size_t> depthHistogram;
+	//maps the number of primitives in a leaf to the number of such leaves
+	std::map<int, size_t> leafSizeHistogram;
+};
+
+//occupancy statistics of a HashGrid
+struct GridBuildStats
+{
+	//number of non-empty cells
+	size_t numCells = 0;
+	//number of primitives inserted into the grid
+	size_t numPrimitives = 0;
+	//number of primitive references stored in all cells, primitives overlapping several cells are counted once per cell
+	size_t numReferences = 0;
+	//maps the number of primitives in a cell to the number of such cells
+	std::map<size_t, size_t> occupancyHistogram;
+
+	//average number of cells a primitive is stored in
+	float Duplication() const { return numPrimitives == 0 ? 0.0f : (float)numReferences / numPrimitives; }
+	//average number of primitives per non-empty cell
+	float AverageOccupancy() const { return numCells == 0 ? 0.0f : (float)numReferences / numCells; }
+};
+
+std::ostream& operator<<(std::ostream& os, const QueryStats& stats);
+std::ostream& operator<<(std::ostream& os, const TreeBuildStats& stats);
+std::ostream& operator<<(std::ostream& os, const GridBuildStats& stats);
@@ -29,6 +29,12 @@ public:
 	Triangle(const Eigen::Vector3f& v0, const Eigen::Vector3f& v1,const Eigen::Vector3f& v2);
 	//constructs a triangle from  the face f of the given halfedge mesh m
 	Triangle(const HEMesh&m, const OpenMesh::FaceHandle& f);
+	//constructs a triangle using the vertex positions v0,v1 and v2 which originates from the face f
+	Triangle(const Eigen::Vector3f& v0, const Eigen::Vector3f& v1, const Eigen::Vector3f& v2, const OpenMesh::FaceHandle& f);
+	//returns the position of vertex i (0, 1 or 2)
+	const Eigen::Vector3f& Vertex(int i) const;
+	//returns the handle of the originating face, it is invalid if the triangle was not created from a face
+	OpenMesh::FaceHandle Face() const;
 	//returns the axis aligned bounding box of the triangle
 	Box ComputeBounds() const;
 	//returns true if the triangle overlaps the given box b
@@ -43,6 +49,9 @@ public:
 	float Distance(const Eigen::Vector3f& p) const;
 	//returns a reference point  which is on the triangle and is used to sort the primitive in the AABB tree construction
 	Eigen::Vector3f ReferencePoint() const;
+	//computes the intersection of the ray origin + t * dir (t >= 0) with the triangle
+	//returns true and the ray parameter t of the intersection if there is one
+	bool IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float& t) const;
 
 };
 
@@ -9,6 +9,8 @@
 #include <util/OpenMeshUtils.h>
 
 #include "AABBTree.h"
+#include "CompressedAABBTree.h"
+#include "OutOfCoreAABBTree.h"
 #include "HashGrid.h"
 #include "Point.h"
 #include "LineSegment.h"
@@ -16,6 +18,10 @@
 
 #include <gui/ShaderPool.h>
 
+#include <chrono>
+#include <iostream>
+#include <random>
+
 class Viewer : public nse::gui::AbstractViewer
 {
 public:
@@ -34,6 +40,107 @@ private:
 	void MeshUpdated();
 
 	void FindClosestPoint(const Eigen::Vector3f& p);
+
+	//runs a closest point query on the tree and on the grid and prints the query statistics of both
+	template <typename Primitive>
+	Eigen::Vector3f FindClosestPoint(const AABBTree<Primitive>& tree, const HashGrid<Primitive>& grid, const Eigen::Vector3f& p)
+	{
+		QueryStats treeStats, gridStats;
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		Eigen::Vector3f closest = tree.ClosestPoint(p, treeStats);
+		auto timeTree = std::chrono::high_resolution_clock::now();
+		grid.ClosestPrimitive(p, gridStats);
+		auto timeGrid = std::chrono::high_resolution_clock::now();
+
+		std::cout << std::fixed << "Closest point query:" << std::endl
+			<< " AABB tree (" << std::chrono::duration_cast<std::chrono::microseconds>(timeTree - timeStart).count() << " microseconds)" << std::endl
+			<< treeStats
+			<< " Hash grid (" << std::chrono::duration_cast<std::chrono::microseconds>(timeGrid - timeTree).count() << " microseconds)" << std::endl
+			<< gridStats;
+		return closest;
+	}
+
+	void BenchmarkClosestPointQueries();
+	void BenchmarkOutOfCoreTree();
+
+	//times the closest primitive query variants of the tree on random query points around the mesh
+	//and compares their results with the default query
+	template <typename Primitive>
+	void BenchmarkClosestPointQueries(const AABBTree<Primitive>& tree, size_t numQueries)
+	{
+		//fixed seed, such that all runs use the same query points
+		std::mt19937 rnd(42);
+		Eigen::Vector3f margin = 0.1f * meshBounds.Extents();
+		std::uniform_real_distribution<float> dist(0, 1);
+		std::vector<Eigen::Vector3f> queries(numQueries);
+		for (auto& q : queries)
+		{
+			Eigen::Vector3f t(dist(rnd), dist(rnd), dist(rnd));
+			q = meshBounds.LowerBound() - margin + t.cwiseProduct(meshBounds.Extents() + 2 * margin);
+		}
+
+		std::vector<float> reference(numQueries), result(numQueries);
+		typedef std::chrono::high_resolution_clock Clock;
+		auto report = [&](const char* name, Clock::time_point start) {
+			auto duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+			size_t mismatches = 0;
+			for (size_t i = 0; i < numQueries; ++i)
+				if (result[i] != reference[i])
+					++mismatches;
+			std::cout << " " << name << ": " << duration / 1000.0 << " ms (" << (double)duration / numQueries << " microseconds per query, "
+				<< mismatches << " mismatches)" << std::endl;
+		};
+		
+		std::cout << std::fixed << "Closest point query benchmark (" << numQueries << " queries):" << std::endl;
+
+		auto start = Clock::now();
+		for (size_t i = 0; i < numQueries; ++i)
+			reference[i] = tree.ClosestPrimitive(queries[i]).sqrDistance;
+		result = reference;
+		report("best-first, reused thread-local context", start);
+
+		start = Clock::now();
+		for (size_t i = 0; i < numQueries; ++i)
+		{
+			//a new context per query allocates its queue every time, like a local priority queue would
+			typename AABBTree<Primitive>::QueryContext context;
+			NoQueryStats stats;
+			result[i] = tree.ClosestPrimitive(queries[i], context, stats).sqrDistance;
+		}
+		report("best-first, new context per query    ", start);
+
+		start = Clock::now();
+		for (size_t i = 0; i < numQueries; ++i)
+			result[i] = tree.ClosestPrimitiveDepthFirst(queries[i]).sqrDistance;
+		report("depth-first, nearest child first     ", start);
+
+		CompressedAABBTree<Primitive, std::uint8_t> tree8(tree);
+		start = Clock::now();
+		for (size_t i = 0; i < numQueries; ++i)
+			result[i] = tree8.ClosestPrimitive(queries[i]).sqrDistance;
+		report("compressed,  8-bit child bounds      ", start);
+
+		CompressedAABBTree<Primitive, std::uint16_t> tree16(tree);
+		start = Clock::now();
+		for (size_t i = 0; i < numQueries; ++i)
+			result[i] = tree16.ClosestPrimitive(queries[i]).sqrDistance;
+		report("compressed, 16-bit child bounds      ", start);
+
+		std::cout << " tree memory (nodes and primitives):" << std::endl
+			<< "  uncompressed: " << tree.MemoryUsage() / 1024 << " KB" << std::endl
+			<< "  8-bit:        " << tree8.MemoryUsage() / 1024 << " KB" << std::endl
+			<< "  16-bit:       " << tree16.MemoryUsage() / 1024 << " KB" << std::endl;
+
+		QueryStats bestFirstStats, depthFirstStats;
+		for (auto& q : queries)
+		{
+			tree.ClosestPrimitive(q, bestFirstStats);
+			tree.ClosestPrimitiveDepthFirst(q, depthFirstStats);
+		}
+		std::cout << " best-first work:" << std::endl << bestFirstStats
+			<< " depth-first work:" << std::endl << depthFirstStats;
+	}
+
 	void BuildGridVBO();
 	void BuildRayVBOs();
 
@@ -67,6 +174,7 @@ private:
 	
 	HEMesh polymesh;
 	float bboxMaxLength;
+	Box meshBounds;
 	MeshRenderer renderer;
 	
 	AABBTree<Point> vertexTree;
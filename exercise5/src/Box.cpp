@@ -5,6 +5,7 @@
 #include "Box.h"
 #include "GridUtils.h"
 #include <limits>
+#include <algorithm>
 
 
 //creates an empty box like the method Clear
@@ -175,4 +176,31 @@ float Box::Distance(const Eigen::Vector3f& p) const
 	return sqrt(SqrDistance(p));
 }
 
+//computes the parameter interval [tEnter,tExit] of the ray origin + t * dir (t >= 0) inside the box
+//returns false if the ray misses the box
+bool Box::IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float& tEnter, float& tExit) const
+{
+	tEnter = 0;
+	tExit = std::numeric_limits<float>::infinity();
+	for (int i = 0; i < 3; ++i)
+	{
+		if (dir[i] == 0)
+		{
+			//the ray is parallel to the slab
+			if (origin[i] < LowerBound()[i] || origin[i] > UpperBound()[i])
+				return false;
+			continue;
+		}
+		float t0 = (LowerBound()[i] - origin[i]) / dir[i];
+		float t1 = (UpperBound()[i] - origin[i]) / dir[i];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		tEnter = (std::max)(tEnter, t0);
+		tExit = (std::min)(tExit, t1);
+		if (tEnter > tExit)
+			return false;
+	}
+	return true;
+}
+
 
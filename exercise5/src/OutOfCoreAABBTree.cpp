@@ -0,0 +1,842 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "OutOfCoreAABBTree.h"
+
+#include <stdio.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+	const uint32_t FormatVersion = 1;
+	const char IndexMagic[8] = { 'C', 'G', '1', 'O', 'O', 'C', 'I', 'X' };
+	const char ChunkMagic[8] = { 'C', 'G', '1', 'O', 'O', 'C', 'C', 'K' };
+
+	//number of triangles which are buffered in memory before they are spilled to the temporary bin files
+	const size_t BufferTriangles = 1 << 20;
+	//number of triangles which are read at once when a bin is split
+	const size_t ReadBlockTriangles = 1 << 16;
+	//maximum number of recursive bin splits, bins of nearly identical triangles cannot be split further
+	const int MaxSplitDepth = 6;
+	//maximum tree depth of the chunk trees
+	const int MaxChunkTreeDepth = 32;
+
+	struct IndexHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t numChunks;
+		uint64_t numTriangles;
+	};
+
+	struct ChunkHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t numNodes;
+		uint32_t numTriangles;
+		uint32_t reserved;
+	};
+
+	//node of a chunk tree, the nodes are stored in depth-first order
+	//split nodes have count == 0, their left child is the next node and offset is the index of the right child
+	//leaves reference the count triangles starting at offset
+	struct FlatNode
+	{
+		float lowerBound[3];
+		float upperBound[3];
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	typedef OutOfCoreAABBTreeBuilder::StoredTriangle StoredTriangle;
+
+	Box NodeBounds(const FlatNode& node)
+	{
+		return Box(Eigen::Vector3f(node.lowerBound[0], node.lowerBound[1], node.lowerBound[2]),
+			Eigen::Vector3f(node.upperBound[0], node.upperBound[1], node.upperBound[2]));
+	}
+
+	Eigen::Vector3f StoredVertex(const StoredTriangle& t, int i)
+	{
+		return Eigen::Vector3f(t.v[i][0], t.v[i][1], t.v[i][2]);
+	}
+
+	Triangle ToTriangle(const StoredTriangle& t)
+	{
+		return Triangle(StoredVertex(t, 0), StoredVertex(t, 1), StoredVertex(t, 2), OpenMesh::FaceHandle(t.face));
+	}
+
+	Eigen::Vector3f Centroid(const StoredTriangle& t)
+	{
+		return (StoredVertex(t, 0) + StoredVertex(t, 1) + StoredVertex(t, 2)) / 3.0f;
+	}
+
+	//returns the index of the cell of a regular grid with resolution^3 cells over the box which contains p
+	size_t CellIndex(const Box& box, int resolution, const Eigen::Vector3f& p)
+	{
+		size_t index = 0;
+		for (int d = 2; d >= 0; --d)
+		{
+			float extent = box.UpperBound()[d] - box.LowerBound()[d];
+			int i = extent > 0 ? (int)((p[d] - box.LowerBound()[d]) / extent * resolution) : 0;
+			i = std::max(0, std::min(resolution - 1, i));
+			index = index * resolution + i;
+		}
+		return index;
+	}
+
+	//returns the cell of a regular grid with resolution^3 cells over the box
+	Box CellBounds(const Box& box, int resolution, size_t index)
+	{
+		Eigen::Vector3f cellSize = box.Extents() / (float)resolution;
+		Eigen::Vector3f lower;
+		for (int d = 0; d < 3; ++d)
+		{
+			lower[d] = box.LowerBound()[d] + (index % resolution) * cellSize[d];
+			index /= resolution;
+		}
+		return Box(lower, lower + cellSize);
+	}
+
+	bool AppendTriangles(const std::string& path, const std::vector<StoredTriangle>& triangles)
+	{
+		FILE* file = fopen(path.c_str(), "ab");
+		if (file == nullptr)
+			return false;
+		bool success = fwrite(triangles.data(), sizeof(StoredTriangle), triangles.size(), file) == triangles.size();
+		return fclose(file) == 0 && success;
+	}
+
+	//appends the subtree of node to the flat node and triangle arrays
+	void Flatten(const AABBTree<Triangle>::AABBNode* node, std::vector<FlatNode>& nodes, std::vector<StoredTriangle>& triangles)
+	{
+		size_t index = nodes.size();
+		nodes.emplace_back();
+		Box bounds = node->GetBounds();
+		for (int d = 0; d < 3; ++d)
+		{
+			nodes[index].lowerBound[d] = bounds.LowerBound()[d];
+			nodes[index].upperBound[d] = bounds.UpperBound()[d];
+		}
+		if (node->IsLeaf())
+		{
+			auto leaf = static_cast<const AABBTree<Triangle>::AABBLeafNode*>(node);
+			nodes[index].offset = (uint32_t)triangles.size();
+			nodes[index].count = (uint32_t)leaf->NumPrimitives();
+			for (auto it = leaf->begin(); it != leaf->end(); ++it)
+			{
+				StoredTriangle t;
+				for (int i = 0; i < 3; ++i)
+					for (int d = 0; d < 3; ++d)
+						t.v[i][d] = it->Vertex(i)[d];
+				t.face = it->Face().idx();
+				triangles.push_back(t);
+			}
+		}
+		else
+		{
+			//Complete() never creates empty split nodes
+			auto split = static_cast<const AABBTree<Triangle>::AABBSplitNode*>(node);
+			Flatten(split->Left(), nodes, triangles);
+			nodes[index].offset = (uint32_t)nodes.size();
+			nodes[index].count = 0;
+			Flatten(split->Right(), nodes, triangles);
+		}
+	}
+
+	//pointers into a mapped chunk file
+	struct ChunkView
+	{
+		const ChunkHeader* header;
+		const FlatNode* nodes;
+		const StoredTriangle* triangles;
+
+		explicit ChunkView(const char* data)
+			: header(reinterpret_cast<const ChunkHeader*>(data)),
+			nodes(reinterpret_cast<const FlatNode*>(data + sizeof(ChunkHeader))),
+			triangles(reinterpret_cast<const StoredTriangle*>(data + sizeof(ChunkHeader) + header->numNodes * sizeof(FlatNode)))
+		{ }
+	};
+
+	//stack entry of the chunk tree traversals
+	struct NodeEntry
+	{
+		float key;
+		uint32_t node;
+	};
+
+	//depth-first closest triangle search in a chunk tree which only improves the current best result
+	template <typename Stats>
+	void ClosestInChunk(const ChunkView& chunk, const Eigen::Vector3f& q, OutOfCoreAABBTree::ResultEntry& best, Stats& stats)
+	{
+		if (chunk.header->numNodes == 0)
+			return;
+		const StoredTriangle* bestTriangle = nullptr;
+		NodeEntry stack[MaxChunkTreeDepth + 1];
+		int stackSize = 0;
+		NodeEntry current = { NodeBounds(chunk.nodes[0]).SqrDistance(q), 0 };
+		stats.CountNode();
+		while (true)
+		{
+			if (current.key < best.sqrDistance)
+			{
+				const FlatNode& node = chunk.nodes[current.node];
+				if (node.count > 0)
+				{
+					stats.CountLeaf();
+					for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+					{
+						stats.CountPrimitiveTest();
+						float dist = ToTriangle(chunk.triangles[i]).SqrDistance(q);
+						if (dist < best.sqrDistance)
+						{
+							best.sqrDistance = dist;
+							bestTriangle = &chunk.triangles[i];
+						}
+					}
+				}
+				else
+				{
+					NodeEntry nearChild = { NodeBounds(chunk.nodes[current.node + 1]).SqrDistance(q), current.node + 1 };
+					NodeEntry farChild = { NodeBounds(chunk.nodes[node.offset]).SqrDistance(q), node.offset };
+					stats.CountNode();
+					stats.CountNode();
+					if (farChild.key < nearChild.key)
+						std::swap(nearChild, farChild);
+					if (farChild.key < best.sqrDistance)
+					{
+						stack[stackSize++] = farChild;
+						stats.CountPush();
+					}
+					current = nearChild;
+					continue;
+				}
+			}
+			if (stackSize == 0)
+				break;
+			current = stack[--stackSize];
+			stats.CountPop();
+		}
+
+		//the result must not point into the mapping, which may be unmapped by the next chunk access
+		if (bestTriangle != nullptr)
+		{
+			Triangle t = ToTriangle(*bestTriangle);
+			best.closestPoint = t.ClosestPoint(q);
+			best.face = t.Face();
+		}
+	}
+
+	//depth-first search for the first ray intersection in a chunk tree which only improves the current best hit
+	template <typename Stats>
+	void IntersectInChunk(const ChunkView& chunk, const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, OutOfCoreAABBTree::RayHit& best, Stats& stats)
+	{
+		if (chunk.header->numNodes == 0)
+			return;
+		NodeEntry stack[MaxChunkTreeDepth + 1];
+		int stackSize = 0;
+		float tEnter, tExit;
+		const float infinity = std::numeric_limits<float>::infinity();
+		stats.CountNode();
+		if (!NodeBounds(chunk.nodes[0]).IntersectRay(origin, dir, tEnter, tExit))
+			return;
+		NodeEntry current = { tEnter, 0 };
+		while (true)
+		{
+			if (current.key < best.t)
+			{
+				const FlatNode& node = chunk.nodes[current.node];
+				if (node.count > 0)
+				{
+					stats.CountLeaf();
+					for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+					{
+						stats.CountPrimitiveTest();
+						float t;
+						Triangle triangle = ToTriangle(chunk.triangles[i]);
+						if (triangle.IntersectRay(origin, dir, t) && t < best.t)
+						{
+							best.t = t;
+							best.face = triangle.Face();
+						}
+					}
+				}
+				else
+				{
+					NodeEntry nearChild = { infinity, current.node + 1 };
+					NodeEntry farChild = { infinity, node.offset };
+					if (NodeBounds(chunk.nodes[nearChild.node]).IntersectRay(origin, dir, tEnter, tExit))
+						nearChild.key = tEnter;
+					if (NodeBounds(chunk.nodes[farChild.node]).IntersectRay(origin, dir, tEnter, tExit))
+						farChild.key = tEnter;
+					stats.CountNode();
+					stats.CountNode();
+					if (farChild.key < nearChild.key)
+						std::swap(nearChild, farChild);
+					if (farChild.key < best.t)
+					{
+						stack[stackSize++] = farChild;
+						stats.CountPush();
+					}
+					current = nearChild;
+					continue;
+				}
+			}
+			if (stackSize == 0)
+				break;
+			current = stack[--stackSize];
+			stats.CountPop();
+		}
+	}
+
+	std::string IndexPath(const std::string& basePath)
+	{
+		return basePath + ".index";
+	}
+
+	std::string ChunkPath(const std::string& basePath, size_t chunk)
+	{
+		return basePath + ".chunk" + std::to_string(chunk);
+	}
+}
+
+std::ostream& operator<<(std::ostream& os, const OutOfCoreIOStats& stats)
+{
+	os << "  chunk hits:      " << stats.chunkHits << std::endl
+	   << "  chunk loads:     " << stats.chunkLoads << std::endl
+	   << "  chunk evictions: " << stats.chunkEvictions << std::endl
+	   << "  bytes loaded:    " << stats.bytesLoaded << std::endl
+	   << "  resident bytes:  " << stats.residentBytes << " (peak " << stats.peakResidentBytes << ")" << std::endl;
+	return os;
+}
+
+OutOfCoreAABBTreeBuilder::OutOfCoreAABBTreeBuilder(const std::string& basePath, const Box& bounds, size_t expectedTriangles, size_t maxChunkTriangles)
+	: basePath(basePath), bounds(bounds), maxChunkTriangles(std::max<size_t>(1, maxChunkTriangles)),
+	bufferedTriangles(0), numTemporaryFiles(0), numTriangles(0), failed(false)
+{
+	//aim for chunks of the maximum size if the triangles were distributed uniformly
+	resolution = (int)std::ceil(std::cbrt((double)expectedTriangles / this->maxChunkTriangles));
+	resolution = std::max(1, std::min(32, resolution));
+	bins.resize(resolution * resolution * resolution);
+	binCounts.resize(bins.size(), 0);
+}
+
+OutOfCoreAABBTreeBuilder::~OutOfCoreAABBTreeBuilder()
+{
+	for (size_t bin = 0; bin < binCounts.size(); ++bin)
+		if (binCounts[bin] > 0)
+			remove(BinPath(bin).c_str());
+}
+
+std::string OutOfCoreAABBTreeBuilder::BinPath(size_t bin) const
+{
+	return basePath + ".bin" + std::to_string(bin) + ".tmp";
+}
+
+void OutOfCoreAABBTreeBuilder::AddTriangle(const Eigen::Vector3f& v0, const Eigen::Vector3f& v1, const Eigen::Vector3f& v2, int faceId)
+{
+	StoredTriangle t;
+	const Eigen::Vector3f* v[3] = { &v0, &v1, &v2 };
+	for (int i = 0; i < 3; ++i)
+		for (int d = 0; d < 3; ++d)
+			t.v[i][d] = (*v[i])[d];
+	t.face = faceId;
+
+	size_t bin = CellIndex(bounds, resolution, Centroid(t));
+	bins[bin].push_back(t);
+	++binCounts[bin];
+	++numTriangles;
+	if (++bufferedTriangles >= BufferTriangles)
+		FlushBins();
+}
+
+bool OutOfCoreAABBTreeBuilder::FlushBins()
+{
+	for (size_t bin = 0; bin < bins.size(); ++bin)
+	{
+		if (bins[bin].empty())
+			continue;
+		if (!AppendTriangles(BinPath(bin), bins[bin]))
+			failed = true;
+		std::vector<StoredTriangle>().swap(bins[bin]);
+	}
+	bufferedTriangles = 0;
+	return !failed;
+}
+
+bool OutOfCoreAABBTreeBuilder::ProcessBin(const std::string& path, size_t count, const Box& cell, int depth)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	if (count <= maxChunkTriangles || depth >= MaxSplitDepth)
+	{
+		std::vector<StoredTriangle> triangles(count);
+		bool success = fread(triangles.data(), sizeof(StoredTriangle), count, file) == count;
+		fclose(file);
+		remove(path.c_str());
+		return success && WriteChunk(triangles);
+	}
+
+	//split the bin into 2x2x2 sub-bins, streaming through its file
+	std::vector<StoredTriangle> block(ReadBlockTriangles);
+	std::vector<StoredTriangle> children[8];
+	size_t childCounts[8] = { 0 };
+	bool success = true;
+	for (size_t read = 0; read < count && success; )
+	{
+		size_t n = std::min(ReadBlockTriangles, count - read);
+		if (fread(block.data(), sizeof(StoredTriangle), n, file) != n)
+		{
+			success = false;
+			break;
+		}
+		read += n;
+		for (size_t i = 0; i < n; ++i)
+			children[CellIndex(cell, 2, Centroid(block[i]))].push_back(block[i]);
+		for (int c = 0; c < 8 && success; ++c)
+		{
+			if (children[c].empty())
+				continue;
+			childCounts[c] += children[c].size();
+			success = AppendTriangles(path + "." + std::to_string(c), children[c]);
+			children[c].clear();
+		}
+	}
+	fclose(file);
+	remove(path.c_str());
+	block = std::vector<StoredTriangle>();
+
+	for (int c = 0; c < 8; ++c)
+	{
+		if (childCounts[c] == 0)
+			continue;
+		std::string childPath = path + "." + std::to_string(c);
+		if (success)
+			success = ProcessBin(childPath, childCounts[c], CellBounds(cell, 2, c), depth + 1);
+		else
+			remove(childPath.c_str());
+	}
+	return success;
+}
+
+bool OutOfCoreAABBTreeBuilder::WriteChunk(std::vector<StoredTriangle>& triangles)
+{
+	AABBTree<Triangle> tree(MaxChunkTreeDepth);
+	for (auto& t : triangles)
+		tree.Insert(ToTriangle(t));
+	std::vector<StoredTriangle>().swap(triangles);
+	tree.Complete();
+
+	std::vector<FlatNode> nodes;
+	std::vector<StoredTriangle> ordered;
+	Flatten(tree.Root(), nodes, ordered);
+
+	ChunkHeader header;
+	memcpy(header.magic, ChunkMagic, sizeof(header.magic));
+	header.version = FormatVersion;
+	header.numNodes = (uint32_t)nodes.size();
+	header.numTriangles = (uint32_t)ordered.size();
+	header.reserved = 0;
+
+	FILE* file = fopen(ChunkPath(basePath, chunks.size()).c_str(), "wb");
+	if (file == nullptr)
+		return false;
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(nodes.data(), sizeof(FlatNode), nodes.size(), file) == nodes.size()
+		&& fwrite(ordered.data(), sizeof(StoredTriangle), ordered.size(), file) == ordered.size();
+	success = fclose(file) == 0 && success;
+
+	ChunkInfo info;
+	for (int d = 0; d < 3; ++d)
+	{
+		info.lowerBound[d] = nodes[0].lowerBound[d];
+		info.upperBound[d] = nodes[0].upperBound[d];
+	}
+	info.numTriangles = header.numTriangles;
+	info.reserved = 0;
+	info.fileSize = sizeof(header) + nodes.size() * sizeof(FlatNode) + ordered.size() * sizeof(StoredTriangle);
+	chunks.push_back(info);
+	return success;
+}
+
+bool OutOfCoreAABBTreeBuilder::Finish()
+{
+	FlushBins();
+	for (size_t bin = 0; bin < binCounts.size(); ++bin)
+	{
+		if (binCounts[bin] == 0)
+			continue;
+		if (!failed && !ProcessBin(BinPath(bin), binCounts[bin], CellBounds(bounds, resolution, bin), 0))
+			failed = true;
+		remove(BinPath(bin).c_str());
+		binCounts[bin] = 0;
+	}
+	if (failed)
+		return false;
+
+	IndexHeader header;
+	memcpy(header.magic, IndexMagic, sizeof(header.magic));
+	header.version = FormatVersion;
+	header.numChunks = (uint32_t)chunks.size();
+	header.numTriangles = numTriangles;
+
+	FILE* file = fopen(IndexPath(basePath).c_str(), "wb");
+	if (file == nullptr)
+		return false;
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(chunks.data(), sizeof(ChunkInfo), chunks.size(), file) == chunks.size();
+	return fclose(file) == 0 && success;
+}
+
+bool BuildOutOfCoreAABBTree(const HEMesh& m, const std::string& basePath, size_t maxChunkTriangles)
+{
+	Box bounds;
+	for (auto v : m.vertices())
+		bounds.Insert(ToEigenVector(m.point(v)));
+
+	OutOfCoreAABBTreeBuilder builder(basePath, bounds, m.n_faces(), maxChunkTriangles);
+	for (auto f : m.faces())
+	{
+		Triangle t(m, f);
+		builder.AddTriangle(t.Vertex(0), t.Vertex(1), t.Vertex(2), f.idx());
+	}
+	return builder.Finish();
+}
+
+bool BuildOutOfCoreAABBTreeFromSTL(const std::string& stlPath, const std::string& basePath, size_t maxChunkTriangles)
+{
+	//binary STL: 80 byte header, triangle count, 50 byte records (normal, three vertices, attribute)
+	const size_t RecordSize = 50;
+	FILE* file = fopen(stlPath.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+	uint32_t numTriangles;
+	if (fseek(file, 80, SEEK_SET) != 0 || fread(&numTriangles, sizeof(uint32_t), 1, file) != 1)
+	{
+		fclose(file);
+		return false;
+	}
+	long dataStart = ftell(file);
+
+	std::vector<char> block(ReadBlockTriangles * RecordSize);
+	auto readVertex = [&](size_t record, int i)
+	{
+		float v[3];
+		memcpy(v, &block[record * RecordSize + 12 + 12 * i], sizeof(v));
+		return Eigen::Vector3f(v[0], v[1], v[2]);
+	};
+
+	//the first pass computes the bounds, the second one bins the triangles
+	Box bounds;
+	for (uint32_t read = 0; read < numTriangles; )
+	{
+		size_t n = std::min<size_t>(ReadBlockTriangles, numTriangles - read);
+		if (fread(block.data(), RecordSize, n, file) != n)
+		{
+			fclose(file);
+			return false;
+		}
+		for (size_t r = 0; r < n; ++r)
+			for (int i = 0; i < 3; ++i)
+				bounds.Insert(readVertex(r, i));
+		read += (uint32_t)n;
+	}
+
+	OutOfCoreAABBTreeBuilder builder(basePath, bounds, numTriangles, maxChunkTriangles);
+	fseek(file, dataStart, SEEK_SET);
+	for (uint32_t read = 0; read < numTriangles; )
+	{
+		size_t n = std::min<size_t>(ReadBlockTriangles, numTriangles - read);
+		if (fread(block.data(), RecordSize, n, file) != n)
+		{
+			fclose(file);
+			return false;
+		}
+		for (size_t r = 0; r < n; ++r)
+			builder.AddTriangle(readVertex(r, 0), readVertex(r, 1), readVertex(r, 2), (int)(read + r));
+		read += (uint32_t)n;
+	}
+	fclose(file);
+	return builder.Finish();
+}
+
+OutOfCoreAABBTree::ResultEntry::ResultEntry()
+	: sqrDistance(std::numeric_limits<float>::infinity()), closestPoint(Eigen::Vector3f::Zero())
+{ }
+
+OutOfCoreAABBTree::RayHit::RayHit()
+	: t(std::numeric_limits<float>::infinity())
+{ }
+
+bool OutOfCoreAABBTree::RayHit::IsHit() const
+{
+	return t < std::numeric_limits<float>::infinity();
+}
+
+OutOfCoreAABBTree::OutOfCoreAABBTree(size_t memoryBudget)
+	: memoryBudget(memoryBudget), numTriangles(0), topTree(20, 1), isOpen(false)
+{ }
+
+bool OutOfCoreAABBTree::Open(const std::string& basePath)
+{
+	Close();
+	FILE* file = fopen(IndexPath(basePath).c_str(), "rb");
+	if (file == nullptr)
+		return false;
+	IndexHeader header;
+	std::vector<OutOfCoreAABBTreeBuilder::ChunkInfo> infos;
+	bool success = fread(&header, sizeof(header), 1, file) == 1
+		&& memcmp(header.magic, IndexMagic, sizeof(header.magic)) == 0
+		&& header.version == FormatVersion;
+	if (success)
+	{
+		infos.resize(header.numChunks);
+		success = fread(infos.data(), sizeof(OutOfCoreAABBTreeBuilder::ChunkInfo), infos.size(), file) == infos.size();
+	}
+	fclose(file);
+	if (!success)
+		return false;
+
+	this->basePath = basePath;
+	numTriangles = (size_t)header.numTriangles;
+	chunks = std::vector<Chunk>(infos.size());
+	for (size_t i = 0; i < infos.size(); ++i)
+	{
+		chunks[i].bounds = Box(Eigen::Vector3f(infos[i].lowerBound[0], infos[i].lowerBound[1], infos[i].lowerBound[2]),
+			Eigen::Vector3f(infos[i].upperBound[0], infos[i].upperBound[1], infos[i].upperBound[2]));
+		chunks[i].numTriangles = infos[i].numTriangles;
+		chunks[i].fileSize = infos[i].fileSize;
+
+		ChunkPrimitive p;
+		p.bounds = chunks[i].bounds;
+		p.chunk = (uint32_t)i;
+		topTree.Insert(p);
+	}
+	topTree.Complete();
+	isOpen = true;
+	return true;
+}
+
+void OutOfCoreAABBTree::Close()
+{
+	lru.clear();
+	chunks.clear();
+	topTree.Clear();
+	numTriangles = 0;
+	ioStats.residentBytes = 0;
+	isOpen = false;
+}
+
+bool OutOfCoreAABBTree::IsOpen() const { return isOpen; }
+
+void OutOfCoreAABBTree::SetMemoryBudget(size_t bytes)
+{
+	memoryBudget = bytes;
+	EvictFor(0);
+}
+
+size_t OutOfCoreAABBTree::NumChunks() const { return chunks.size(); }
+
+size_t OutOfCoreAABBTree::NumTriangles() const { return numTriangles; }
+
+size_t OutOfCoreAABBTree::DataSize() const
+{
+	size_t size = 0;
+	for (auto& chunk : chunks)
+		size += (size_t)chunk.fileSize;
+	return size;
+}
+
+const OutOfCoreIOStats& OutOfCoreAABBTree::IOStats() const { return ioStats; }
+
+void OutOfCoreAABBTree::ResetIOStats()
+{
+	size_t resident = ioStats.residentBytes;
+	ioStats = OutOfCoreIOStats();
+	ioStats.residentBytes = ioStats.peakResidentBytes = resident;
+}
+
+void OutOfCoreAABBTree::RemoveFiles(const std::string& basePath)
+{
+	for (size_t chunk = 0; remove(ChunkPath(basePath, chunk).c_str()) == 0; ++chunk)
+		;
+	remove(IndexPath(basePath).c_str());
+}
+
+void OutOfCoreAABBTree::EvictFor(size_t additionalBytes)
+{
+	while (!lru.empty() && ioStats.residentBytes + additionalBytes > memoryBudget)
+	{
+		Chunk& victim = chunks[lru.back()];
+		lru.pop_back();
+		ioStats.residentBytes -= victim.file.Size();
+		victim.file.Close();
+		++ioStats.chunkEvictions;
+	}
+}
+
+const char* OutOfCoreAABBTree::AcquireChunk(uint32_t chunk)
+{
+	Chunk& c = chunks[chunk];
+	if (c.file.IsOpen())
+	{
+		++ioStats.chunkHits;
+		lru.splice(lru.begin(), lru, c.lruPosition);
+		return static_cast<const char*>(c.file.Data());
+	}
+
+	//a single chunk is mapped even if it alone exceeds the budget
+	EvictFor((size_t)c.fileSize);
+	std::string path = ChunkPath(basePath, chunk);
+	if (!c.file.Open(path.c_str()))
+		throw std::runtime_error("Cannot map chunk file " + path);
+	const ChunkHeader* header = static_cast<const ChunkHeader*>(c.file.Data());
+	if (c.file.Size() != c.fileSize || c.file.Size() < sizeof(ChunkHeader)
+		|| memcmp(header->magic, ChunkMagic, sizeof(header->magic)) != 0 || header->version != FormatVersion)
+	{
+		c.file.Close();
+		throw std::runtime_error("Invalid chunk file " + path);
+	}
+
+	++ioStats.chunkLoads;
+	ioStats.bytesLoaded += c.file.Size();
+	ioStats.residentBytes += c.file.Size();
+	ioStats.peakResidentBytes = std::max(ioStats.peakResidentBytes, ioStats.residentBytes);
+	lru.push_front(chunk);
+	c.lruPosition = lru.begin();
+	return static_cast<const char*>(c.file.Data());
+}
+
+template <typename Stats>
+OutOfCoreAABBTree::ResultEntry OutOfCoreAABBTree::ClosestPrimitiveImpl(const Eigen::Vector3f& q, Stats& stats)
+{
+	stats.CountQuery();
+	ResultEntry best;
+	if (chunks.empty())
+		return best;
+
+	//best-first search over the top tree, the chunks are searched in the order of their distance
+	heap.clear();
+	heap.push_back({ topTree.Root()->GetBounds().SqrDistance(q), topTree.Root() });
+	stats.CountNode();
+	stats.CountPush();
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end());
+		SearchEntry current = heap.back();
+		heap.pop_back();
+		stats.CountPop();
+		if (current.key >= best.sqrDistance)
+			break;
+
+		if (current.node->IsLeaf())
+		{
+			auto leaf = static_cast<const AABBTree<ChunkPrimitive>::AABBLeafNode*>(current.node);
+			for (auto it = leaf->begin(); it != leaf->end(); ++it)
+				if (it->SqrDistance(q) < best.sqrDistance)
+					ClosestInChunk(ChunkView(AcquireChunk(it->chunk)), q, best, stats);
+		}
+		else
+		{
+			auto split = static_cast<const AABBTree<ChunkPrimitive>::AABBSplitNode*>(current.node);
+			const AABBTree<ChunkPrimitive>::AABBNode* children[2] = { split->Left(), split->Right() };
+			for (auto child : children)
+			{
+				if (child == nullptr)
+					continue;
+				stats.CountNode();
+				stats.CountPush();
+				heap.push_back({ child->GetBounds().SqrDistance(q), child });
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+	}
+	return best;
+}
+
+template <typename Stats>
+OutOfCoreAABBTree::RayHit OutOfCoreAABBTree::IntersectRayImpl(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax, Stats& stats)
+{
+	stats.CountQuery();
+	RayHit best;
+	best.t = tMax;
+	float tEnter, tExit;
+	if (!chunks.empty() && topTree.Root()->GetBounds().IntersectRay(origin, dir, tEnter, tExit))
+	{
+		//the chunks are searched in the order in which the ray enters them
+		heap.clear();
+		heap.push_back({ tEnter, topTree.Root() });
+		stats.CountNode();
+		stats.CountPush();
+		while (!heap.empty())
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			SearchEntry current = heap.back();
+			heap.pop_back();
+			stats.CountPop();
+			if (current.key >= best.t)
+				break;
+
+			if (current.node->IsLeaf())
+			{
+				auto leaf = static_cast<const AABBTree<ChunkPrimitive>::AABBLeafNode*>(current.node);
+				for (auto it = leaf->begin(); it != leaf->end(); ++it)
+					if (it->bounds.IntersectRay(origin, dir, tEnter, tExit) && tEnter < best.t)
+						IntersectInChunk(ChunkView(AcquireChunk(it->chunk)), origin, dir, best, stats);
+			}
+			else
+			{
+				auto split = static_cast<const AABBTree<ChunkPrimitive>::AABBSplitNode*>(current.node);
+				const AABBTree<ChunkPrimitive>::AABBNode* children[2] = { split->Left(), split->Right() };
+				for (auto child : children)
+				{
+					if (child == nullptr)
+						continue;
+					stats.CountNode();
+					if (!child->GetBounds().IntersectRay(origin, dir, tEnter, tExit) || tEnter >= best.t)
+						continue;
+					stats.CountPush();
+					heap.push_back({ tEnter, child });
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+		}
+	}
+	if (!(best.t < tMax))
+		best = RayHit();
+	return best;
+}
+
+OutOfCoreAABBTree::ResultEntry OutOfCoreAABBTree::ClosestPrimitive(const Eigen::Vector3f& q)
+{
+	NoQueryStats stats;
+	return ClosestPrimitiveImpl(q, stats);
+}
+
+OutOfCoreAABBTree::ResultEntry OutOfCoreAABBTree::ClosestPrimitive(const Eigen::Vector3f& q, QueryStats& stats)
+{
+	return ClosestPrimitiveImpl(q, stats);
+}
+
+Eigen::Vector3f OutOfCoreAABBTree::ClosestPoint(const Eigen::Vector3f& p)
+{
+	return ClosestPrimitive(p).closestPoint;
+}
+
+OutOfCoreAABBTree::RayHit OutOfCoreAABBTree::IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax)
+{
+	NoQueryStats stats;
+	return IntersectRayImpl(origin, dir, tMax, stats);
+}
+
+OutOfCoreAABBTree::RayHit OutOfCoreAABBTree::IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float tMax, QueryStats& stats)
+{
+	return IntersectRayImpl(origin, dir, tMax, stats);
+}
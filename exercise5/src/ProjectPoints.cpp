@@ -0,0 +1,169 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+/*
+Headless batch projection of a point cloud onto a mesh.
+
+usage: ProjectPoints <mesh file (.itri or any format OpenMesh reads)> <point file> <output file> [threads] [points per chunk]
+
+The point file contains float32 x, y, z triples without header. For every point, the output file contains a
+record of the float32 distance to the closest triangle followed by the int32 index of this triangle's face
+(the faces are numbered after the mesh has been triangulated). Points are read, projected and written in
+chunks, so the files can be larger than the main memory. Every result only depends on its point, the output
+does not depend on the number of threads.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <algorithm>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <util/ThreadPool.h>
+
+#include "AABBTree.h"
+
+namespace
+{
+	//output record of a single point
+	struct ProjectionResult
+	{
+		float distance;
+		int32_t face;
+	};
+
+	//the histogram bins are the decades of the distance relative to the mesh diagonal: [0, 1e-6), [1e-6, 1e-5), ..., [1e-1, 1), [1, inf)
+	const int FirstDecade = -6;
+	const int NumHistogramBins = 8;
+
+	int HistogramBin(float distance, float diagonal)
+	{
+		float relative = distance / diagonal;
+		if (!(relative >= std::pow(10.0f, (float)FirstDecade)))
+			return 0;
+		int bin = (int)std::floor(std::log10(relative)) - FirstDecade + 1;
+		return std::min(NumHistogramBins - 1, std::max(1, bin));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		std::cerr << "usage: " << argv[0] << " <mesh file> <point file> <output file> [threads] [points per chunk]" << std::endl;
+		return 1;
+	}
+	unsigned int numThreads = argc > 4 ? (unsigned int)std::stoul(argv[4]) : 0;
+	size_t chunkSize = argc > 5 ? std::stoull(argv[5]) : (1 << 20);
+	chunkSize = std::max<size_t>(1, chunkSize);
+
+	typedef std::chrono::high_resolution_clock Clock;
+	auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+	HEMesh mesh;
+	if (!ReadMeshFile(argv[1], mesh))
+	{
+		std::cerr << "Cannot read mesh " << argv[1] << std::endl;
+		return 1;
+	}
+	mesh.triangulate();
+
+	AABBTree<Triangle> tree;
+	BuildAABBTreeFromTriangles(mesh, tree);
+	Box bounds;
+	for (auto v : mesh.vertices())
+		bounds.Insert(ToEigenVector(mesh.point(v)));
+	float diagonal = std::max(bounds.Extents().norm(), std::numeric_limits<float>::min());
+
+	std::ifstream input(argv[2], std::ios::binary);
+	if (!input)
+	{
+		std::cerr << "Cannot open point file " << argv[2] << std::endl;
+		return 1;
+	}
+	std::ofstream output(argv[3], std::ios::binary);
+	if (!output)
+	{
+		std::cerr << "Cannot open output file " << argv[3] << std::endl;
+		return 1;
+	}
+
+	nse::util::ThreadPool pool(numThreads);
+	std::cout << "Projecting points with " << pool.NumThreads() << " threads .." << std::endl;
+
+	std::vector<std::array<float, 3>> points(chunkSize);
+	std::vector<ProjectionResult> results(chunkSize);
+	std::array<size_t, NumHistogramBins> histogram = {};
+	size_t numPoints = 0;
+	double sumDistances = 0, maxDistance = 0;
+	Clock::duration queryTime = Clock::duration::zero();
+	auto timeStart = Clock::now();
+
+	while (true)
+	{
+		input.read(reinterpret_cast<char*>(points.data()), chunkSize * sizeof(points[0]));
+		size_t n = (size_t)input.gcount() / sizeof(points[0]);
+		if (n == 0)
+			break;
+
+		auto queryStart = Clock::now();
+		pool.ParallelForChunks(n, 1024, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				Eigen::Vector3f p(points[i][0], points[i][1], points[i][2]);
+				auto closest = tree.ClosestPrimitive(p);
+				results[i].distance = std::sqrt(closest.sqrDistance);
+				results[i].face = closest.prim == nullptr ? -1 : closest.prim->Face().idx();
+			}
+		});
+		queryTime += Clock::now() - queryStart;
+
+		//statistics are accumulated in point order, so they are independent of the thread count as well
+		for (size_t i = 0; i < n; ++i)
+		{
+			++histogram[HistogramBin(results[i].distance, diagonal)];
+			sumDistances += results[i].distance;
+			maxDistance = std::max(maxDistance, (double)results[i].distance);
+		}
+
+		output.write(reinterpret_cast<const char*>(results.data()), n * sizeof(results[0]));
+		if (!output)
+		{
+			std::cerr << "Cannot write output file " << argv[3] << std::endl;
+			return 1;
+		}
+		numPoints += n;
+		if (n < chunkSize)
+			break;
+	}
+	if (input.gcount() % sizeof(points[0]) != 0)
+		std::cerr << "Warning: ignored " << input.gcount() % sizeof(points[0]) << " trailing bytes of the point file" << std::endl;
+
+	double totalTime = seconds(Clock::now() - timeStart);
+	std::cout << "Projected " << numPoints << " points in " << totalTime << " s (queries " << seconds(queryTime) << " s)" << std::endl
+		<< "  points per second:           " << (totalTime > 0 ? numPoints / totalTime : 0) << std::endl
+		<< "  points per second (queries): " << (seconds(queryTime) > 0 ? numPoints / seconds(queryTime) : 0) << std::endl
+		<< "  mean distance: " << (numPoints > 0 ? sumDistances / numPoints : 0) << std::endl
+		<< "  max distance:  " << maxDistance << std::endl
+		<< "  distance histogram (relative to the bounding box diagonal " << diagonal << "):" << std::endl;
+	for (int bin = 0; bin < NumHistogramBins; ++bin)
+	{
+		std::cout << "  ";
+		if (bin == 0)
+			std::cout << "[0, 1e" << FirstDecade << ")";
+		else if (bin == NumHistogramBins - 1)
+			std::cout << "[1e" << FirstDecade + bin - 1 << ", inf)";
+		else
+			std::cout << "[1e" << FirstDecade + bin - 1 << ", 1e" << FirstDecade + bin << ")";
+		std::cout << ": " << histogram[bin] << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,64 @@
+// This source code is property of the Computer Graphics and Visualization 
+// chair of the TU Dresden. Do not distribute! 
+// Copyright (C) CGV TU Dresden - All Rights Reserved
+
+#include "QueryStats.h"
+
+void QueryStats::Reset()
+{
+	*this = QueryStats();
+}
+
+QueryStats& QueryStats::operator+=(const QueryStats& other)
+{
+	nodesVisited += other.nodesVisited;
+	leavesVisited += other.leavesVisited;
+	primitiveTests += other.primitiveTests;
+	queuePushes += other.queuePushes;
+	queuePops += other.queuePops;
+	queries += other.queries;
+	return *this;
+}
+
+//writes a histogram as a single line of "key:count" pairs
+template <typename Histogram>
+static void PrintHistogram(std::ostream& os, const Histogram& histogram)
+{
+	for (auto& entry : histogram)
+		os << " " << entry.first << ":" << entry.second;
+	os << std::endl;
+}
+
+std::ostream& operator<<(std::ostream& os, const QueryStats& stats)
+{
+	os << "  queries:         " << stats.queries << std::endl
+	   << "  nodes visited:   " << stats.nodesVisited << std::endl
+	   << "  leaves visited:  " << stats.leavesVisited << std::endl
+	   << "  primitive tests: " << stats.primitiveTests << std::endl
+	   << "  queue pushes:    " << stats.queuePushes << std::endl
+	   << "  queue pops:      " << stats.queuePops << std::endl;
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const TreeBuildStats& stats)
+{
+	os << "  nodes:      " << stats.numNodes << " (" << stats.numLeaves << " leaves)" << std::endl
+	   << "  primitives: " << stats.numPrimitives << std::endl
+	   << "  max depth:  " << stats.maxDepth << std::endl
+	   << "  leaf depth histogram (depth:leaves):";
+	PrintHistogram(os, stats.depthHistogram);
+	os << "  leaf size histogram (primitives:leaves):";
+	PrintHistogram(os, stats.leafSizeHistogram);
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const GridBuildStats& stats)
+{
+	os << "  non-empty cells: " << stats.numCells << std::endl
+	   << "  primitives:      " << stats.numPrimitives << std::endl
+	   << "  references:      " << stats.numReferences << " (duplication " << stats.Duplication() << ")" << std::endl
+	   << "  avg. occupancy:  " << stats.AverageOccupancy() << std::endl
+	   << "  occupancy histogram (primitives:cells):";
+	PrintHistogram(os, stats.occupancyHistogram);
+	return os;
+}
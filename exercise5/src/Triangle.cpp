@@ -25,6 +25,21 @@ Triangle::Triangle(const HEMesh&m, const OpenMesh::FaceHandle& f):h(f)
 	he = m.next_halfedge_handle(he);
 	v2 = ToEigenVector(m.point(m.from_vertex_handle(he)));
 }
+//constructs a triangle using the vertex positions v0,v1 and v2 which originates from the face f
+Triangle::Triangle(const Eigen::Vector3f& v0, const Eigen::Vector3f& v1, const Eigen::Vector3f& v2, const OpenMesh::FaceHandle& f)
+	: v0(v0), v1(v1), v2(v2), h(f)
+{
+}
+//returns the position of vertex i (0, 1 or 2)
+const Eigen::Vector3f& Triangle::Vertex(int i) const
+{
+	return i == 0 ? v0 : (i == 1 ? v1 : v2);
+}
+//returns the handle of the originating face, it is invalid if the triangle was not created from a face
+OpenMesh::FaceHandle Triangle::Face() const
+{
+	return h;
+}
 //returns the smallest axis aligned bounding box of the triangle
 Box Triangle::ComputeBounds() const
 {
@@ -254,6 +269,28 @@ Eigen::Vector3f Triangle::ReferencePoint() const
 {
 	return (v0+v1+v2)/3.0f;
 }
+//computes the intersection of the ray origin + t * dir (t >= 0) with the triangle (Moeller-Trumbore)
+//returns true and the ray parameter t of the intersection if there is one
+bool Triangle::IntersectRay(const Eigen::Vector3f& origin, const Eigen::Vector3f& dir, float& t) const
+{
+	Eigen::Vector3f e1 = v1 - v0;
+	Eigen::Vector3f e2 = v2 - v0;
+	Eigen::Vector3f p = dir.cross(e2);
+	float det = e1.dot(p);
+	if (det == 0)
+		return false;
+	float invDet = 1.0f / det;
+	Eigen::Vector3f s = origin - v0;
+	float u = s.dot(p) * invDet;
+	if (u < 0 || u > 1)
+		return false;
+	Eigen::Vector3f qv = s.cross(e1);
+	float v = dir.dot(qv) * invDet;
+	if (v < 0 || u + v > 1)
+		return false;
+	t = e2.dot(qv) * invDet;
+	return t >= 0;
+}
 
 
 
@@ -45,11 +45,12 @@ void Viewer::SetupGUI()
 	loadFileBtn->setCallback([this]() {
 		std::vector<std::pair<std::string, std::string>> fileTypes;
 		fileTypes.push_back(std::make_pair("obj", "OBJ File"));
+		fileTypes.push_back(std::make_pair("itri", "Indexed Triangle File"));
 		auto file = nanogui::file_dialog(fileTypes, false);
 		if (!file.empty())
 		{
 			polymesh.clear();
-			if (!OpenMesh::IO::read_mesh(polymesh, file))
+			if (!ReadMeshFile(file, polymesh))
 			{
 				new nanogui::MessageDialog(this, nanogui::MessageDialog::Type::Warning, "Load Mesh",
 					"The specified file could not be loaded");
@@ -64,6 +65,12 @@ void Viewer::SetupGUI()
 	
 	sldQuery = new nse::gui::VectorInput(mainWindow, "Query", Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), [this](const Eigen::Vector3f& p) { FindClosestPoint(p); });
 
+	auto benchmarkBtn = new nanogui::Button(mainWindow, "Benchmark Closest Point Queries");
+	benchmarkBtn->setCallback([this]() { BenchmarkClosestPointQueries(); });
+
+	auto outOfCoreBtn = new nanogui::Button(mainWindow, "Benchmark Out-Of-Core Tree");
+	outOfCoreBtn->setCallback([this]() { BenchmarkOutOfCoreTree(); });
+
 	sldRayOrigin = new nse::gui::VectorInput(mainWindow, "Ray Origin", Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), [this](const Eigen::Vector3f& p) { BuildRayVBOs(); });
 	sldRayDir = new nse::gui::VectorInput(mainWindow, "Ray Direction", Eigen::Vector3f::Constant(-1), Eigen::Vector3f::Constant(1), Eigen::Vector3f::Zero(), [this](const Eigen::Vector3f& p) { BuildRayVBOs(); });
 	nanogui::TextBox* txtRaySteps;
@@ -89,21 +96,18 @@ void Viewer::FindClosestPoint(const Eigen::Vector3f& p)
 	if (polymesh.vertices_empty())
 		return;
 	Eigen::Vector3f closest;
-	auto timeStart = std::chrono::high_resolution_clock::now();
 	switch (cmbPrimitiveType->selectedIndex())
 	{
 	case Vertex:
-		closest = vertexTree.ClosestPoint(p);
+		closest = FindClosestPoint(vertexTree, vertexGrid, p);
 		break;
 	case Edge:
-		closest = edgeTree.ClosestPoint(p);
+		closest = FindClosestPoint(edgeTree, edgeGrid, p);
 		break;
 	case Tri:
-		closest = triangleTree.ClosestPoint(p);
+		closest = FindClosestPoint(triangleTree, triangleGrid, p);
 		break;
 	}	
-	auto timeEnd = std::chrono::high_resolution_clock::now();
-	std::cout << std::fixed << "Closest point query took " << std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count() << " microseconds." << std::endl;
 
 	Eigen::Matrix4Xf points(4, 2);
 	points.block<3, 1>(0, 0) = p;
@@ -116,6 +120,94 @@ void Viewer::FindClosestPoint(const Eigen::Vector3f& p)
 	closestVAO.unbind();
 }
 
+void Viewer::BenchmarkClosestPointQueries()
+{
+	if (polymesh.vertices_empty())
+		return;
+	const size_t numQueries = 100000;
+	switch (cmbPrimitiveType->selectedIndex())
+	{
+	case Vertex:
+		BenchmarkClosestPointQueries(vertexTree, numQueries);
+		break;
+	case Edge:
+		BenchmarkClosestPointQueries(edgeTree, numQueries);
+		break;
+	case Tri:
+		BenchmarkClosestPointQueries(triangleTree, numQueries);
+		break;
+	}
+}
+
+void Viewer::BenchmarkOutOfCoreTree()
+{
+	if (polymesh.vertices_empty())
+		return;
+	typedef std::chrono::high_resolution_clock Clock;
+	auto milliseconds = [](Clock::time_point start) { return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count(); };
+
+	//split the mesh into about 64 chunks and allow a quarter of them to be mapped at the same time
+	const std::string basePath = "OutOfCoreTree";
+	auto start = Clock::now();
+	if (!BuildOutOfCoreAABBTree(polymesh, basePath, std::max<size_t>(256, polymesh.n_faces() / 64)))
+	{
+		std::cout << "Could not write the out-of-core tree to " << basePath << std::endl;
+		return;
+	}
+	std::cout << "Out-of-core tree benchmark:" << std::endl
+		<< " build: " << milliseconds(start) << " ms" << std::endl;
+
+	OutOfCoreAABBTree tree;
+	if (!tree.Open(basePath))
+	{
+		std::cout << "Could not open the out-of-core tree " << basePath << std::endl;
+		return;
+	}
+	tree.SetMemoryBudget(tree.DataSize() / 4);
+	std::cout << " " << tree.NumChunks() << " chunks, " << tree.DataSize() / 1024 << " KB, memory budget " << tree.DataSize() / 4 / 1024 << " KB" << std::endl;
+
+	std::mt19937 rnd(42);
+	std::uniform_real_distribution<float> dist(0, 1);
+	auto randomPoint = [&]() { return Eigen::Vector3f(meshBounds.LowerBound() + Eigen::Vector3f(dist(rnd), dist(rnd), dist(rnd)).cwiseProduct(meshBounds.Extents())); };
+
+	const size_t numQueries = 10000;
+	size_t mismatches = 0;
+	QueryStats stats;
+	start = Clock::now();
+	for (size_t i = 0; i < numQueries; ++i)
+	{
+		Eigen::Vector3f q = randomPoint();
+		if (tree.ClosestPrimitive(q, stats).sqrDistance != triangleTree.ClosestPrimitive(q).sqrDistance)
+			++mismatches;
+	}
+	std::cout << " " << numQueries << " closest point queries: " << milliseconds(start) << " ms (including the in-memory reference), "
+		<< mismatches << " mismatches" << std::endl << stats << tree.IOStats();
+
+	//rays are compared with a linear search over all faces
+	const size_t numRays = 100;
+	mismatches = 0;
+	size_t hits = 0;
+	tree.ResetIOStats();
+	for (size_t i = 0; i < numRays; ++i)
+	{
+		Eigen::Vector3f origin = randomPoint();
+		Eigen::Vector3f dir = randomPoint() - origin;
+		auto hit = tree.IntersectRay(origin, dir);
+		float closestT = std::numeric_limits<float>::infinity(), t;
+		for (auto f : polymesh.faces())
+			if (Triangle(polymesh, f).IntersectRay(origin, dir, t))
+				closestT = std::min(closestT, t);
+		if (hit.t != closestT)
+			++mismatches;
+		if (hit.IsHit())
+			++hits;
+	}
+	std::cout << " " << numRays << " ray queries: " << hits << " hits, " << mismatches << " mismatches" << std::endl << tree.IOStats();
+
+	tree.Close();
+	OutOfCoreAABBTree::RemoveFiles(basePath);
+}
+
 void Viewer::MeshUpdated()
 {
 	//calculate the bounding Box of the mesh
@@ -124,6 +216,7 @@ void Viewer::MeshUpdated()
 		bbox.expand(ToEigenVector(polymesh.point(v)));
 	camera().FocusOnBBox(bbox);		
 	bboxMaxLength = bbox.diagonal().maxCoeff();
+	meshBounds = Box(bbox.min, bbox.max);
 
 	polymesh.triangulate();
 	
@@ -136,6 +229,13 @@ void Viewer::MeshUpdated()
 	BuildHashGridFromEdges(polymesh, edgeGrid, cellSize);
 	BuildHashGridFromTriangles(polymesh, triangleGrid, cellSize);		
 
+	std::cout << "Vertex AABB tree:" << std::endl << vertexTree.ComputeBuildStats()
+		<< "Edge AABB tree:" << std::endl << edgeTree.ComputeBuildStats()
+		<< "Triangle AABB tree:" << std::endl << triangleTree.ComputeBuildStats()
+		<< "Vertex hash grid:" << std::endl << vertexGrid.ComputeBuildStats()
+		<< "Edge hash grid:" << std::endl << edgeGrid.ComputeBuildStats()
+		<< "Triangle hash grid:" << std::endl << triangleGrid.ComputeBuildStats();
+
 	sldQuery->SetBounds(bbox.min, bbox.max);
 	sldQuery->SetValue(bbox.max);
 	FindClosestPoint(bbox.max);